@@ -0,0 +1,87 @@
+/**
+ * ALIAS TABLE CLASS
+ */
+
+#include "alias_table.h"
+#include <algorithm>
+#include <vector>
+
+alias_table::alias_table() {}
+
+/**
+ * @brief alias_table::alias_table
+ * builds the columns with Vose's algorithm in O(N):
+ * - weights are scaled so that the mean column holds 1
+ * - an outcome below 1 (small) fills its column up with the excess of an outcome above 1 (large),
+ *   which becomes its alias and may turn small itself
+ * - outcomes left over at the end hold a full column up to rounding
+ */
+alias_table::alias_table(const std::vector<double>& weights) {
+    const int N = weights.size();
+    double total = 0;
+    for (double w : weights) {
+        total += w;
+    }
+    probabilities.resize(N);
+    threshold.assign(N, 1.0f);
+    alias.resize(N);
+
+    std::vector<double> scaled(N);
+    std::vector<int> small;
+    std::vector<int> large;
+    for (int i = 0; i < N; i++) {
+        probabilities[i] = weights[i] / total;
+        scaled[i] = probabilities[i] * N;
+        alias[i] = i;
+        if (scaled[i] < 1.0) {
+            small.push_back(i);
+        } else {
+            large.push_back(i);
+        }
+    }
+    while (!small.empty() && !large.empty()) {
+        int s = small.back();
+        small.pop_back();
+        int l = large.back();
+        threshold[s] = static_cast<float>(scaled[s]);
+        alias[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+}
+
+/**
+ * @brief alias_table::sample
+ * constant time draw from two independent fields of the random bits:
+ * - the column from the upper 32 bits, scaled to 0 .. N - 1 by a multiplication instead of a division
+ * - the side of its threshold from the lower 32 bits, so the thresholds are resolved to 2^-32 for any number of
+ *   columns, a single 24 bit uniform for both would resolve them only to N / 2^24, too coarse for the rare tail bins
+ */
+int alias_table::sample(std::uint64_t random_bits) const {
+    float position;
+    return sample(random_bits, position);
+}
+
+int alias_table::sample(std::uint64_t random_bits, float& position) const {
+    const std::uint64_t N = threshold.size();
+    const int column = static_cast<int>(((random_bits >> 32) * N) >> 32);
+    const double f = static_cast<double>(random_bits & 0xffffffffULL) * (1.0 / 4294967296.0);
+    const double column_threshold = threshold[column];
+    if (f < column_threshold) {
+        position = static_cast<float>(f / column_threshold);
+        return column;
+    }
+    position = std::min(static_cast<float>((f - column_threshold) / (1.0 - column_threshold)), 1.0f);
+    return alias[column];
+}
+
+double alias_table::get_probability(int i) const {
+    return probabilities[i];
+}
+
+int alias_table::size() const {
+    return threshold.size();
+}
@@ -0,0 +1,32 @@
+#ifndef ALIAS_TABLE_H
+#define ALIAS_TABLE_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The alias_table class
+ * Walker's alias method for drawing from a discrete distribution in constant time: every outcome owns one column
+ * of equal probability, split at a threshold between the outcome itself and its alias. A draw picks the column
+ * with the upper 32 bits of a 64 bit engine output and the side of the threshold with the lower 32 bits,
+ * independent of the shape of the distribution and of the number of outcomes.
+ */
+class alias_table {
+public:
+    // Constructors
+    alias_table();
+    explicit alias_table(const std::vector<double>& weights);     // weights need not be normalised, at least one must be positive
+
+    // Member functions
+    int sample(std::uint64_t random_bits) const;            // outcome for 64 uniform random bits, e.g. one splitmix64 output
+    int sample(std::uint64_t random_bits, float& position) const;  // also returns a new uniform in [0, 1) left over from the bits
+    double get_probability(int i) const;                    // normalised weight of outcome i
+    int size() const;
+
+private:
+    std::vector<float> threshold;                           // share of column i that belongs to outcome i itself
+    std::vector<int> alias;                                 // outcome owning the rest of column i
+    std::vector<double> probabilities;
+};
+
+#endif // ALIAS_TABLE_H
@@ -0,0 +1,79 @@
+/**
+ * ANALYSIS PIPELINE CLASS
+ */
+
+#include "analysis_pipeline.h"
+#include <utility>
+
+analysis_pipeline::analysis_pipeline(analysis analyse) : analyse(std::move(analyse)) {}
+
+analysis_pipeline::~analysis_pipeline() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    snapshot_ready.notify_one();
+    if (consumer.joinable()) {
+        consumer.join();
+    }
+}
+
+/**
+ * @brief analysis_pipeline::submit
+ * - waits until the consumer is done with the previous snapshot, then the snapshot is not read by anyone
+ * - the first snapshot after a reset() copies the patches with their environment, later years only copy
+ *   the counts and the occupancy into the same arrays, see patch_grid::copy_state()
+ */
+void analysis_pipeline::submit(const patch_grid& patches, int year) {
+    wait();
+    if (has_snapshot && snapshot.get_x_size() == patches.get_x_size() && snapshot.get_y_size() == patches.get_y_size()) {
+        snapshot.copy_state(patches);
+    } else {
+        snapshot = patches;
+        has_snapshot = true;
+    }
+    snapshot_year = year;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = true;
+    }
+    if (!consumer.joinable()) {
+        consumer = std::thread(&analysis_pipeline::work, this);
+    }
+    snapshot_ready.notify_one();
+}
+
+void analysis_pipeline::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    snapshot_done.wait(lock, [this] { return !pending; });
+}
+
+/**
+ * @brief analysis_pipeline::reset
+ * the environment of the patches (burnt area, light, water) is only copied with the whole grid,
+ * so after a new setup the next snapshot must not keep the one of the previous setup
+ */
+void analysis_pipeline::reset() {
+    wait();
+    has_snapshot = false;
+}
+
+/**
+ * @brief analysis_pipeline::work
+ * consumer thread, analyses each snapshot once and hands it back
+ */
+void analysis_pipeline::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        snapshot_ready.wait(lock, [this] { return pending || stopping; });
+        if (!pending) {
+            return;                                     // stopping with no snapshot left
+        }
+        lock.unlock();
+        analyse(snapshot, snapshot_year);
+        lock.lock();
+        pending = false;
+        snapshot_done.notify_all();
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef ANALYSIS_PIPELINE_H
+#define ANALYSIS_PIPELINE_H
+
+#include "patch_grid.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief The analysis_pipeline class
+ * Double buffering of the simulation state: submit() copies the patches of year t into a snapshot grid,
+ * and a consumer thread analyses the snapshot (counting, summaries, output) while the workers already
+ * advance the live patches to year t + 1. There is only one snapshot, so the extra memory is one copy of
+ * the state; submit() waits if the analysis of the previous year is still running.
+ * The consumer thread is started with the first snapshot, the analyses run one after the other in year order.
+ * Later snapshots only copy the state, so reset() must be called when the patches are set up again.
+ */
+class analysis_pipeline {
+public:
+    typedef std::function<void(const patch_grid& snapshot, int year)> analysis;
+
+    explicit analysis_pipeline(analysis analyse);
+    ~analysis_pipeline();                               // waits for the last analysis and stops the consumer thread
+    analysis_pipeline(const analysis_pipeline&) = delete;
+    analysis_pipeline& operator=(const analysis_pipeline&) = delete;
+
+    void submit(const patch_grid& patches, int year);   // snapshot of the patches for the analysis of the year, returns before it is analysed
+    void wait();                                        // until the last submitted snapshot is analysed
+    void reset();                                       // waits, then the next snapshot copies the whole grid again, call after every setup
+
+private:
+    void work();
+
+    analysis analyse;
+    patch_grid snapshot;                                // read-only for the consumer while an analysis is pending
+    int snapshot_year = 0;
+    bool has_snapshot = false;                          // the first snapshot after reset() copies the whole grid, later ones only the state
+    std::thread consumer;
+    std::mutex mutex;
+    std::condition_variable snapshot_ready;
+    std::condition_variable snapshot_done;
+    bool pending = false;                               // a snapshot waits for or is in its analysis
+    bool stopping = false;
+};
+
+#endif // ANALYSIS_PIPELINE_H
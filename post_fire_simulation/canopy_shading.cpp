@@ -0,0 +1,96 @@
+/**
+ * CANOPY SHADING
+ */
+
+#include "canopy_shading.h"
+#include <algorithm>
+#include <vector>
+
+static const int N_box_passes = 3;     // three boxes give a smooth, nearly Gaussian kernel with a finite reach
+
+/**
+ * @brief box_filter_row
+ * applies the N_box_passes box filters to one row of the grid
+ * - running sums, one addition and one subtraction per point whatever the radius
+ * - the row is padded with the reach of the kernel on both sides, so shade cast beyond the map edge
+ *   by one pass is still there for the next, same as summing the kernel of every tree
+ * @param f first value of the row, the values are stride apart and overwritten with the result
+ * @param values, sums work buffers of at least N + 2 * N_box_passes * radius elements
+ */
+static void box_filter_row(long long* f, int N, int stride, int radius, std::vector<long long>& values, std::vector<long long>& sums) {
+    const int pad = N_box_passes * radius;
+    const int N_padded = N + 2 * pad;
+    std::fill(values.begin(), values.begin() + N_padded, 0);
+    for (int q = 0; q < N; q++) {
+        values[pad + q] = f[q * stride];
+    }
+    for (int pass = 0; pass < N_box_passes; pass++) {
+        long long sum = 0;
+        for (int q = 0; q < radius && q < N_padded; q++) {
+            sum += values[q];
+        }
+        for (int q = 0; q < N_padded; q++) {
+            if (q + radius < N_padded) {
+                sum += values[q + radius];          // value entering the box
+            }
+            if (q - radius - 1 >= 0) {
+                sum -= values[q - radius - 1];      // value leaving the box
+            }
+            sums[q] = sum;
+        }
+        values.swap(sums);
+    }
+    for (int q = 0; q < N; q++) {
+        f[q * stride] = values[pad + q];
+    }
+}
+
+/**
+ * @brief shading_kernel_weights
+ * the box of ones convolved with itself N_box_passes times, i.e. the response of box_filter() to a single tree
+ */
+std::vector<long long> shading_kernel_weights(int box_radius) {
+    std::vector<long long> weights = {1};
+    for (int pass = 0; pass < N_box_passes; pass++) {
+        std::vector<long long> widened(weights.size() + 2 * box_radius, 0);
+        for (size_t i = 0; i < weights.size(); i++) {
+            for (int j = 0; j <= 2 * box_radius; j++) {
+                widened[i + j] += weights[i];
+            }
+        }
+        weights = widened;
+    }
+    return weights;
+}
+
+/**
+ * @brief canopy_shading
+ * replaces summing the shading of every tree on every patch, O(patches) instead of O(patches * trees)
+ * - all sums are integers, so the result does not depend on the order of the trees
+ * - burnt trees are still standing and shade as before, removed trees are no longer in the tree vector
+ */
+std::vector<float> canopy_shading(const std::vector<tree>& trees, int x_size, int y_size, int box_radius) {
+    std::vector<long long> crowns(x_size * y_size, 0);
+    for (auto& t : trees) {
+        crowns[t.x_y_cor[0] * y_size + t.x_y_cor[1]]++;
+    }
+
+    const int N_padded = std::max(x_size, y_size) + 2 * N_box_passes * box_radius;
+    std::vector<long long> values(N_padded);
+    std::vector<long long> sums(N_padded);
+    for (int x = 0; x < x_size; x++) {
+        box_filter_row(&crowns[x * y_size], y_size, 1, box_radius, values, sums);
+    }
+    for (int y = 0; y < y_size; y++) {
+        box_filter_row(&crowns[y], x_size, y_size, box_radius, values, sums);
+    }
+
+    // a tree on the patch itself shades it completely
+    const long long peak = shading_kernel_weights(box_radius)[N_box_passes * box_radius];
+    const double norm = 1.0 / static_cast<double>(peak * peak);
+    std::vector<float> shading(crowns.size());
+    for (size_t i = 0; i < crowns.size(); i++) {
+        shading[i] = static_cast<float>(crowns[i] * norm);
+    }
+    return shading;
+}
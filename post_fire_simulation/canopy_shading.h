@@ -0,0 +1,25 @@
+#ifndef CANOPY_SHADING_H
+#define CANOPY_SHADING_H
+
+#include "tree.h"
+#include <vector>
+
+/**
+ * Canopy shading of all trees: the tree-crown raster (trees per patch) is convolved with a shading kernel made of
+ * three iterated box filters along x and three along y. Each box pass is a running sum, so the cost is linear in the
+ * number of patches for any number of trees and any box radius. Grids use the index x * y_size + y of patch_grid::index().
+ */
+
+// light models selectable in the ui, same order as the items of light_model_comboBox
+enum class light_model {
+    nearest_tree,       // light from the distance to the nearest tree only, 1 - 1 / distance below 6 patches
+    canopy_shading      // light from the summed shading of all trees within reach, see canopy_shading()
+};
+
+// 1D weights of the shading kernel for offsets -3 * box_radius .. 3 * box_radius, peak 3 * r^2 + 3 * r + 1
+std::vector<long long> shading_kernel_weights(int box_radius);
+
+// shading of every patch, a single tree shades its own patch with 1 and reaches 3 * box_radius patches
+std::vector<float> canopy_shading(const std::vector<tree>& trees, int x_size, int y_size, int box_radius = 2);
+
+#endif // CANOPY_SHADING_H
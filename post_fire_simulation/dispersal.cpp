@@ -0,0 +1,288 @@
+/**
+ * SEED DISPERSAL
+ */
+
+#include "dispersal.h"
+#include "parallel.h"
+#include "seed_trajectory.h"
+#include "sim_random.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <random>
+
+/**
+ * @brief throw_seeds
+ * Seed trajectories of a single tree for one year, one seed after the other as in the original model
+ * - the real seed production is a random value between 0 and 1 multiplied by the max seed production
+ * - seeds are dispersed in a uniform 360 degree direction
+ * - dispersal distance is modelled as exponential function
+ * @param deposit called with the destination coordinates of every seed landing inside the map
+ */
+template <typename Engine, typename Deposit>
+static void throw_seeds(const tree& t, int x_size, int y_size, Engine& gen, Deposit deposit) {
+    std::uniform_real_distribution<float> rand_float_01(0.0f, 1.0f);    // random float between 0 and 1 for seed production and dispersal distance
+
+    int real_seed_production = t.max_seed_production * rand_float_01(gen);     // real seed production as random number * max seed production
+    for (int i = 1; i <= real_seed_production; i++) {
+        float direction = 2 * M_PI * i / real_seed_production;             // direction of seed dispersal
+
+        float distance_decay = std::pow(2, -3 * rand_float_01(gen));          // distance decay of seed dispersal
+
+        int offset_x = static_cast<int>(t.dispersal_factor * distance_decay * cos(direction));
+        int offset_y = static_cast<int>(t.dispersal_factor * distance_decay * sin(direction));
+
+        int new_x = t.x_y_cor[0] + offset_x;
+        int new_y = t.x_y_cor[1] + offset_y;
+
+        // check if seed landed in the map extent (no torus wrapping implemented)
+        if (new_x >= 0 && new_x < x_size && new_y >= 0 && new_y < y_size) {
+            deposit(new_x, new_y);
+        }
+    }
+}
+
+/**
+ * @brief throw_seed_batch
+ * Seed trajectories of a single tree for one year from its own stream, shared by the scatter procedures
+ * - the real seed production is a uniform random value multiplied by the max seed production
+ * - the uniforms of all seeds are drawn into the batch at once and the landing offsets of all seeds
+ *   are computed by the vectorised kernel with the direction tables of the species stencil
+ *   (same direction and distance decay as throw_seeds())
+ * @param deposit called with the destination coordinates of every seed landing inside the map
+ */
+template <typename Deposit>
+static void throw_seed_batch(const tree& t, const dispersal_stencil& stencil, int x_size, int y_size, splitmix64& gen, seed_batch& batch, Deposit deposit) {
+    int real_seed_production = t.max_seed_production * uniform_float(gen);
+    batch.draw(real_seed_production, gen);
+    stencil.generate_offsets(batch);
+
+    const int x = t.x_y_cor[0];
+    const int y = t.x_y_cor[1];
+    for (int i = 0; i < real_seed_production; i++) {
+        int new_x = x + batch.offset_x[i];
+        int new_y = y + batch.offset_y[i];
+        if (new_x >= 0 && new_x < x_size && new_y >= 0 && new_y < y_size) {
+            deposit(new_x, new_y);
+        }
+    }
+}
+
+/**
+ * @brief disperse_seeds
+ * Exact per-seed dispersal, one annual time step, all trees drawing from the single simulation engine,
+ * kept as the reference implementation of the original model
+ * - seeds are registered to the destination patch with a constant time grid lookup,
+ *   so the cost grows with the number of seeds but not with the map area
+ */
+void disperse_seeds(const std::vector<tree>& trees, patch_grid& patches, std::mt19937& gen) {
+    for (auto& t : trees) {
+        if(t.burnt == false){
+            throw_seeds(t, patches.get_x_size(), patches.get_y_size(), gen, [&](int new_x, int new_y) {
+                patches.at(new_x, new_y).update_N_seeds(1, t.species);
+                patches.mark_occupied(patches.index(new_x, new_y));
+            });
+        }
+    }
+}
+
+/**
+ * @brief seed_count_raster::reset
+ * resizes the raster to the given map extent and sets all counts to 0
+ */
+void seed_count_raster::reset(int x_size, int y_size) {
+    this->x_size = x_size;
+    this->y_size = y_size;
+    for (auto& species_counts : counts) {
+        species_counts.assign(x_size * y_size, 0);
+    }
+}
+
+/**
+ * @brief scatter_seeds
+ * Exact per-seed dispersal into a seed count raster, trees in their vector order
+ * - every tree draws from its own splitmix64 stream keyed by the dispersal seed and the tree id,
+ *   so the seeds of a tree do not depend on which trees were processed before
+ * - consecutive trees are spread randomly over the map, so almost every count is a cache miss on large maps
+ */
+void scatter_seeds(const std::vector<tree>& trees, const dispersal_stencil_set& stencils, seed_count_raster& raster, std::uint64_t seed) {
+    const int y_size = raster.y_size;
+    seed_batch batch;
+    for (auto& t : trees) {
+        if (t.burnt == false) {
+            splitmix64 tree_gen(seed, t.id);
+            std::vector<int>& counts = raster.counts[species_index(t.species)];
+            throw_seed_batch(t, stencils.for_species(t.species), raster.x_size, raster.y_size, tree_gen, batch, [&](int new_x, int new_y) {
+                counts[new_x * y_size + new_y]++;
+            });
+        }
+    }
+}
+
+/**
+ * @brief scatter_seeds_tiled
+ * Exact per-seed dispersal into a seed count raster, same counts as scatter_seeds() for the same seed
+ * - trees are bucketed by tile of tile_size * tile_size patches with a counting sort
+ * - the seeds of all trees in a tile are counted into a tile buffer extended by a halo of the largest
+ *   seed offset of the dispersal kernels, small enough to stay in L1/L2 while the seeds of the tile are thrown
+ * - the buffer is then flushed into the raster row by row, which streams through memory
+ * - the rare seeds of a long-distance tail landing beyond the halo are collected per thread and added at the end,
+ *   so the tiles keep their size however far the tail reaches
+ * - with more than one thread, tiles are at least two halos wide and processed in four phases of
+ *   a 2 * 2 checkerboard, so tiles of the same phase never flush into the same patches, each phase is one run of the pool
+ * Integer counts do not depend on the order of the additions, so the result is the same for any number of threads.
+ */
+void scatter_seeds_tiled(const std::vector<tree>& trees, const dispersal_stencil_set& stencils, seed_count_raster& raster, std::uint64_t seed, thread_pool& pool, int tile_size) {
+    const int N_threads = pool.size();
+    const int x_size = raster.x_size;
+    const int y_size = raster.y_size;
+
+    int halo = 0;                                                       // largest possible seed offset
+    for (auto& t : trees) {
+        if (t.burnt == false) {
+            halo = std::max(halo, stencils.for_species(t.species).local_max_distance());
+        }
+    }
+    if (N_threads > 1) {
+        tile_size = std::max(tile_size, 2 * halo);                      // tiles of one phase must not share patches
+    }
+    const int N_tiles_x = (x_size + tile_size - 1) / tile_size;
+    const int N_tiles_y = (y_size + tile_size - 1) / tile_size;
+    const int N_tiles = N_tiles_x * N_tiles_y;
+    const int buffer_edge = tile_size + 2 * halo;
+
+    // counting sort of the unburnt trees by tile
+    std::vector<int> tile_start(N_tiles + 1, 0);
+    auto tile_of = [&](const tree& t) {
+        return (t.x_y_cor[0] / tile_size) * N_tiles_y + t.x_y_cor[1] / tile_size;
+    };
+    for (auto& t : trees) {
+        if (t.burnt == false) {
+            tile_start[tile_of(t) + 1]++;
+        }
+    }
+    for (int i = 0; i < N_tiles; i++) {
+        tile_start[i + 1] += tile_start[i];
+    }
+    std::vector<const tree*> sorted_trees(tile_start[N_tiles]);
+    std::vector<int> next_slot(tile_start.begin(), tile_start.end() - 1);
+    for (auto& t : trees) {
+        if (t.burnt == false) {
+            sorted_trees[next_slot[tile_of(t)]++] = &t;
+        }
+    }
+
+    // throws the seeds of one tile into the buffer and flushes it into the raster
+    auto process_tile = [&](int tile, std::vector<int>* buffer, std::vector<int>* far_seeds, seed_batch& batch) {
+        if (tile_start[tile] == tile_start[tile + 1]) {
+            return;                                                     // no trees in this tile
+        }
+        const int x0 = (tile / N_tiles_y) * tile_size - halo;           // map coordinates of the buffer origin
+        const int y0 = (tile % N_tiles_y) * tile_size - halo;
+        for (int s = 0; s < N_species; s++) {
+            buffer[s].assign(buffer_edge * buffer_edge, 0);
+        }
+
+        for (int i = tile_start[tile]; i < tile_start[tile + 1]; i++) {
+            const tree& t = *sorted_trees[i];
+            splitmix64 tree_gen(seed, t.id);
+            const int s = species_index(t.species);
+            throw_seed_batch(t, stencils.for_species(t.species), x_size, y_size, tree_gen, batch, [&](int new_x, int new_y) {
+                const int buffer_x = new_x - x0;
+                const int buffer_y = new_y - y0;
+                if (buffer_x >= 0 && buffer_x < buffer_edge && buffer_y >= 0 && buffer_y < buffer_edge) {
+                    buffer[s][buffer_x * buffer_edge + buffer_y]++;
+                } else {
+                    far_seeds[s].push_back(new_x * y_size + new_y);
+                }
+            });
+        }
+
+        const int y_first = std::max(0, y0);
+        const int y_last = std::min(y_size, y0 + buffer_edge);
+        for (int s = 0; s < N_species; s++) {
+            for (int x = std::max(0, x0); x < std::min(x_size, x0 + buffer_edge); x++) {
+                const int* row = buffer[s].data() + (x - x0) * buffer_edge;
+                int* target = raster.counts[s].data() + x * y_size;
+                for (int y = y_first; y < y_last; y++) {
+                    target[y] += row[y - y0];
+                }
+            }
+        }
+    };
+
+    // adds the long-distance seeds of one thread to the raster
+    auto flush_far_seeds = [&](std::vector<int>* far_seeds) {
+        for (int s = 0; s < N_species; s++) {
+            for (int i : far_seeds[s]) {
+                raster.counts[s][i]++;
+            }
+            far_seeds[s].clear();
+        }
+    };
+
+    if (N_threads <= 1) {
+        std::vector<int> buffer[N_species];
+        std::vector<int> far_seeds[N_species];
+        seed_batch batch;
+        for (int tile = 0; tile < N_tiles; tile++) {
+            process_tile(tile, buffer, far_seeds, batch);
+        }
+        flush_far_seeds(far_seeds);
+        return;
+    }
+
+    std::vector<std::vector<int>> far_seeds(N_species * N_threads);    // all species per thread
+    for (int phase = 0; phase < 4; phase++) {
+        std::vector<int> phase_tiles;                                   // tiles of this checkerboard phase
+        for (int tile = 0; tile < N_tiles; tile++) {
+            if ((tile / N_tiles_y) % 2 == phase / 2 && (tile % N_tiles_y) % 2 == phase % 2) {
+                phase_tiles.push_back(tile);
+            }
+        }
+        pool.run([&](int thread) {
+            std::vector<int> buffer[N_species];
+            seed_batch batch;
+            for (size_t i = thread; i < phase_tiles.size(); i += N_threads) {
+                process_tile(phase_tiles[i], buffer, &far_seeds[N_species * thread], batch);
+            }
+        });
+    }
+    for (int thread = 0; thread < N_threads; thread++) {
+        flush_far_seeds(&far_seeds[N_species * thread]);
+    }
+}
+
+/**
+ * @brief deposit_seeds
+ * adds the counted seeds of one year to the patches
+ */
+void deposit_seeds(const seed_count_raster& raster, patch_grid& patches) {
+    population_store& populations = patches.get_populations();
+    for (int i = 0; i < raster.x_size * raster.y_size; i++) {
+        bool arrived = false;
+        for (int j = 0; j < N_species; j++) {
+            if (raster.counts[j][i] > 0) {
+                populations.counts(stage_seeds, j)[i] += raster.counts[j][i];
+                arrived = true;
+            }
+        }
+        if (arrived) {
+            patches.mark_occupied(i);
+        }
+    }
+}
+
+/**
+ * @brief disperse_seeds_parallel
+ * Exact per-seed dispersal, one annual time step, across threads
+ * - the seeds are counted with scatter_seeds_tiled(), every tree draws from its own stream keyed by the seed and its id
+ * - the counts are then added to the patches in one pass over the grid
+ * The result only depends on the seed, never on the number of threads.
+ */
+void disperse_seeds_parallel(const std::vector<tree>& trees, const dispersal_stencil_set& stencils, patch_grid& patches, std::uint64_t seed, thread_pool& pool) {
+    seed_count_raster raster;
+    raster.reset(patches.get_x_size(), patches.get_y_size());
+    scatter_seeds_tiled(trees, stencils, raster, seed, pool);
+    deposit_seeds(raster, patches);
+}
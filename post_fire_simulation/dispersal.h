@@ -0,0 +1,60 @@
+#ifndef DISPERSAL_H
+#define DISPERSAL_H
+
+#include "tree.h"
+#include "patch_grid.h"
+#include "dispersal_stencil.h"
+#include "parallel.h"
+#include <cstdint>
+#include <vector>
+#include <random>
+
+/**
+ * Seed dispersal procedures working on the trees and the patch grid,
+ * kept outside of MainWindow so they can be tested and benchmarked without the ui.
+ * They only write simulation state, the map is drawn from the patches by MainWindow::update_map().
+ */
+
+// dispersal engines selectable in the ui, same order as the items of dispersal_mode_comboBox
+enum class dispersal_mode {
+    exact_per_seed,         // every seed is thrown individually, see disperse_seeds_parallel()
+    cached_seed_rain,       // Poisson draws from the expected seed rain built at setup, see seed_rain_field
+    convolution_seed_rain   // Poisson draws from the expected seed rain convolved by FFT from the current trees each year
+};
+
+// exact per-seed dispersal of all unburnt trees
+void disperse_seeds(const std::vector<tree>& trees,     // all trees of the map, burnt trees do not disperse
+                    patch_grid& patches,                // grid receiving the seeds
+                    std::mt19937& gen);                 // random number engine of the simulation
+
+// number of seeds per patch and species landed in one year, same index as patch_grid::index()
+class seed_count_raster {
+public:
+    void reset(int x_size, int y_size);     // resizes the raster and sets all counts to 0
+
+    int x_size = 0;
+    int y_size = 0;
+    std::vector<int> counts[N_species];     // same order as model_species, first element is birch, second is oak
+};
+
+// plain scatter of all seeds into the raster in tree order, each tree draws from its own stream keyed by the seed and its id
+// and its seeds land according to the stencil of its species
+void scatter_seeds(const std::vector<tree>& trees, const dispersal_stencil_set& stencils, seed_count_raster& raster, std::uint64_t seed);
+
+// same seeds as scatter_seeds(), but trees are bucketed by spatial tile and counted into small tile buffers
+// with a halo of the largest dispersal factor, which are flushed into the raster tile by tile
+void scatter_seeds_tiled(const std::vector<tree>& trees, const dispersal_stencil_set& stencils, seed_count_raster& raster, std::uint64_t seed,
+                         thread_pool& pool,                 // worker threads started at setup
+                         int tile_size = 64);               // edge length of a tile in patches
+
+// adds the counted seeds to the patches
+void deposit_seeds(const seed_count_raster& raster, patch_grid& patches);
+
+// exact per-seed dispersal across threads with tile buffers, the result only depends on the seed and never on the number of threads
+void disperse_seeds_parallel(const std::vector<tree>& trees,
+                             const dispersal_stencil_set& stencils,     // direction tables of the species, built at setup
+                             patch_grid& patches,
+                             std::uint64_t seed,                // dispersal seed of this year
+                             thread_pool& pool);                // worker threads started at setup
+
+#endif // DISPERSAL_H
@@ -0,0 +1,221 @@
+#ifndef DISPERSAL_KERNEL_H
+#define DISPERSAL_KERNEL_H
+
+#include "alias_table.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Dispersal kernels as policy types for the seed trajectory loops in dispersal_stencil.cpp.
+ * Every kernel maps the uniform u of a seed to its dispersal distance in patches with the closed-form
+ * inverse of its distance distribution, so the seed loop is instantiated once per kernel and has
+ * neither virtual calls nor branches per seed.
+ * The alternative kernels are scaled by the dispersal factor of the species to the mean distance of the
+ * original model (0.42 * dispersal_factor) and truncated at their max_distance by drawing from the first
+ * cdf(max_distance) of the distribution. The exponential, 2Dt and lognormal kernels end at kernel_max_range
+ * dispersal factors, the fat-tailed kernel keeps its power-law tail up to the long-distance range.
+ * Seed rain with a long-distance tail is drawn from an alias table over the discretised distance distribution
+ * of the kernel mixed with the long_distance_kernel, which takes constant time per seed for any kernel shape.
+ */
+
+// kernels selectable per species, same order as the kernel combo boxes in the ui
+enum class dispersal_kernel_type {
+    model,
+    exponential,
+    student_2dt,
+    lognormal,
+    fat_tailed
+};
+
+inline const char* dispersal_kernel_name(dispersal_kernel_type kernel) {
+    switch (kernel) {
+    case dispersal_kernel_type::exponential:
+        return "exponential";
+    case dispersal_kernel_type::student_2dt:
+        return "2Dt";
+    case dispersal_kernel_type::lognormal:
+        return "lognormal";
+    case dispersal_kernel_type::fat_tailed:
+        return "fat-tailed";
+    default:
+        return "model";
+    }
+}
+
+constexpr float kernel_mean_distance = 0.42078f;    // mean of 2^(-3u), the mean distance of the model in dispersal factors
+constexpr float kernel_max_range = 2.0f;            // truncation of the thin-tailed kernels and body of the fat-tailed kernel in dispersal factors
+
+/**
+ * @brief The model_kernel struct
+ * distance decay of the original model, dispersal_factor * 2^(-3u) between 1/8 and 1 dispersal factor
+ */
+struct model_kernel {
+    static constexpr float max_range = 1.0f;
+    static constexpr float cut = 1.0f;
+
+    explicit model_kernel(int dispersal_factor) : factor(dispersal_factor) {}
+    float cdf(float r) const {
+        return r < factor / 8 ? 0.0f : (r >= factor ? 1.0f : 1.0f + std::log2(r / factor) / 3.0f);
+    }
+    float distance(float u) const {
+        float distance_decay = std::pow(2, -3 * u);
+        return factor * distance_decay;
+    }
+
+    float factor;
+};
+
+/**
+ * @brief The exponential_kernel struct
+ * exponentially distributed distance, cdf 1 - exp(-r / a)
+ */
+struct exponential_kernel {
+    explicit exponential_kernel(int dispersal_factor)
+        : a(kernel_mean_distance * dispersal_factor), max_distance(kernel_max_range * dispersal_factor), cut(cdf(max_distance)) {}
+    float cdf(float r) const {
+        return 1.0f - std::exp(-r / a);
+    }
+    float distance(float u) const {
+        return -a * std::log(1.0f - u * cut);
+    }
+
+    float a;
+    float max_distance;     // truncation in patches
+    float cut;
+};
+
+/**
+ * @brief The student_2dt_kernel struct
+ * 2Dt kernel of Clark et al. (1999) with shape p = 1, distance cdf 1 - (1 + r^2 / b)^-p
+ */
+struct student_2dt_kernel {
+    static constexpr float p = 1.0f;
+
+    explicit student_2dt_kernel(int dispersal_factor)
+        : b(std::pow(kernel_mean_distance * dispersal_factor * 2.0f / static_cast<float>(M_PI), 2.0f)),   // mean pi / 2 * sqrt(b)
+          max_distance(kernel_max_range * dispersal_factor), cut(cdf(max_distance)) {}
+    float cdf(float r) const {
+        return 1.0f - std::pow(1.0f + r * r / b, -p);
+    }
+    float distance(float u) const {
+        return std::sqrt(b * (std::pow(1.0f - u * cut, -1.0f / p) - 1.0f));
+    }
+
+    float b;
+    float max_distance;     // truncation in patches
+    float cut;
+};
+
+/**
+ * @brief The lognormal_kernel struct
+ * lognormally distributed distance with sigma = 1, the inverse normal cdf is the rational
+ * approximation of Acklam (relative error below 1.2e-9), far below float precision
+ */
+struct lognormal_kernel {
+    static constexpr float sigma = 1.0f;
+
+    explicit lognormal_kernel(int dispersal_factor)
+        : mu(std::log(kernel_mean_distance * dispersal_factor) - sigma * sigma / 2), max_distance(kernel_max_range * dispersal_factor),
+          cut(cdf(max_distance)) {}
+    float cdf(float r) const {
+        return r <= 0 ? 0.0f : 0.5f * std::erfc(-(std::log(r) - mu) / (sigma * static_cast<float>(M_SQRT2)));
+    }
+    float distance(float u) const {
+        // u is moved to the middle of its 2^-24 bin, the inverse normal cdf is infinite at 0
+        return std::exp(mu + sigma * inverse_normal_cdf((u + 0.5f / 16777216.0f) * cut));
+    }
+
+    static float inverse_normal_cdf(float p) {
+        static const float a[6] = {-3.969683028665376e+01f, 2.209460984245205e+02f, -2.759285104469687e+02f,
+                                   1.383577518672690e+02f, -3.066479806614716e+01f, 2.506628277459239e+00f};
+        static const float b[5] = {-5.447609879822406e+01f, 1.615858368580409e+02f, -1.556989798598866e+02f,
+                                   6.680131188771972e+01f, -1.328068155288572e+01f};
+        static const float c[6] = {-7.784894002430293e-03f, -3.223964580411365e-01f, -2.400758277161838e+00f,
+                                   -2.549732539343734e+00f, 4.374664141464968e+00f, 2.938163982698783e+00f};
+        static const float d[4] = {7.784695709041462e-03f, 3.224671290700398e-01f, 2.445134137142996e+00f,
+                                   3.754408661907416e+00f};
+        if (p < 0.02425f) {
+            float q = std::sqrt(-2 * std::log(p));
+            return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                   ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+        }
+        if (p > 1 - 0.02425f) {
+            float q = std::sqrt(-2 * std::log(1 - p));
+            return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                    ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+        }
+        float q = p - 0.5f;
+        float r = q * q;
+        return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+               (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+    }
+
+    float mu;
+    float max_distance;     // truncation in patches
+    float cut;
+};
+
+/**
+ * @brief The fat_tailed_kernel struct
+ * power-law tail (Lomax), distance cdf 1 - (1 + r / a)^-b with b = 2, mean a / (b - 1),
+ * truncated at the long-distance range so the heavy tail is kept, but never before kernel_max_range dispersal factors
+ */
+struct fat_tailed_kernel {
+    static constexpr float b = 2.0f;
+
+    explicit fat_tailed_kernel(int dispersal_factor, int range = 0)
+        : a(kernel_mean_distance * dispersal_factor * (b - 1)),
+          max_distance(std::max(kernel_max_range * dispersal_factor, static_cast<float>(range))), cut(cdf(max_distance)) {}
+    float cdf(float r) const {
+        return 1.0f - std::pow(1.0f + r / a, -b);
+    }
+    float distance(float u) const {
+        return a * (std::pow(1.0f - u * cut, -1.0f / b) - 1.0f);
+    }
+
+    float a;
+    float max_distance;     // truncation in patches
+    float cut;
+};
+
+/**
+ * @brief The long_distance_kernel struct
+ * tail of rare long-distance dispersal, e.g. oaks cached by jays or birch seeds carried by storms,
+ * power law with cdf 1 - (1 + r / a)^-1 and a = dispersal_factor, truncated at range patches
+ */
+struct long_distance_kernel {
+    long_distance_kernel(int dispersal_factor, int range)
+        : a(dispersal_factor), cut(cdf(range)) {}
+    float cdf(float r) const {
+        return r / (a + r);
+    }
+    float distance(float u) const {
+        float v = u * cut;
+        return a * v / (1.0f - v);
+    }
+
+    float a;
+    float cut;
+};
+
+/**
+ * @brief The alias_kernel struct
+ * distance distribution discretised into bins of bin_width patches and drawn with an alias table,
+ * from the 64 random bits of the seed instead of its 24 bit uniform, the position within the bin is uniform
+ * and comes from the remainder of the bits
+ */
+struct alias_kernel {
+    static constexpr float bin_width = 0.25f;
+
+    explicit alias_kernel(const alias_table& table) : table(&table) {}
+    float distance(std::uint64_t random_bits) const {
+        float position;
+        int bin = table->sample(random_bits, position);
+        return (bin + position) * bin_width;
+    }
+
+    const alias_table* table;
+};
+
+#endif // DISPERSAL_KERNEL_H
@@ -0,0 +1,271 @@
+/**
+ * DISPERSAL STENCIL CLASS
+ */
+
+#include "dispersal_stencil.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief truncated_cdf
+ * share of the seeds of a kernel policy landing closer than r, normalised to the truncation of the kernel
+ */
+template <typename Kernel>
+static double truncated_cdf(const Kernel& kernel, float r) {
+    return std::min(1.0f, kernel.cdf(r) / kernel.cut);
+}
+
+static double kernel_cdf(dispersal_kernel_type kernel, int dispersal_factor, int range, float r) {
+    switch (kernel) {
+    case dispersal_kernel_type::exponential:
+        return truncated_cdf(exponential_kernel(dispersal_factor), r);
+    case dispersal_kernel_type::student_2dt:
+        return truncated_cdf(student_2dt_kernel(dispersal_factor), r);
+    case dispersal_kernel_type::lognormal:
+        return truncated_cdf(lognormal_kernel(dispersal_factor), r);
+    case dispersal_kernel_type::fat_tailed:
+        return truncated_cdf(fat_tailed_kernel(dispersal_factor, range), r);
+    default:
+        return truncated_cdf(model_kernel(dispersal_factor), r);
+    }
+}
+
+dispersal_stencil::dispersal_stencil() {}
+
+/**
+ * @brief dispersal_stencil::dispersal_stencil
+ * tabulates the directions of every seed for every possible seed count 0 .. max_seed_production
+ * - with a long-distance tail, the distance distribution of the kernel mixed with the tail is discretised
+ *   into bins of alias_kernel::bin_width patches up to the longest distance and put into an alias table
+ * @param dispersal_factor maximum dispersal distance of the species in patches
+ * @param max_seed_production maximum number of seeds per tree and year
+ * @param settings dispersal kernel and long-distance tail of the species, see dispersal_kernel.h
+ */
+dispersal_stencil::dispersal_stencil(int dispersal_factor, int max_seed_production, dispersal_settings settings)
+    : dispersal_factor(dispersal_factor), max_seed_production(max_seed_production), kernel(settings.kernel),
+      long_distance_share(settings.long_distance_share), long_distance_range(settings.long_distance_range) {
+    const size_t table_size = static_cast<size_t>(max_seed_production + 1) * max_seed_production / 2;
+    cos_directions.resize(table_size);
+    sin_directions.resize(table_size);
+    for (int N_seeds = 1; N_seeds <= max_seed_production; N_seeds++) {
+        size_t start = static_cast<size_t>(N_seeds) * (N_seeds - 1) / 2;
+        for (int i = 1; i <= N_seeds; i++) {
+            direction_sincos(i, N_seeds, sin_directions[start + i - 1], cos_directions[start + i - 1]);
+        }
+    }
+
+    if (long_distance_share > 0) {
+        const long_distance_kernel tail(dispersal_factor, long_distance_range);
+        const int N_bins = static_cast<int>(std::ceil(max_distance() / alias_kernel::bin_width));
+        std::vector<double> weights(N_bins);
+        for (int k = 0; k < N_bins; k++) {
+            float r0 = k * alias_kernel::bin_width;
+            float r1 = (k + 1) * alias_kernel::bin_width;
+            double local = kernel_cdf(kernel, dispersal_factor, long_distance_range, r1) - kernel_cdf(kernel, dispersal_factor, long_distance_range, r0);
+            double long_distance = r0 < long_distance_range ? truncated_cdf(tail, std::min<float>(r1, long_distance_range)) - truncated_cdf(tail, r0) : 0.0;
+            weights[k] = (1 - long_distance_share) * std::max(0.0, local) + long_distance_share * std::max(0.0, long_distance);
+        }
+        distance_table = alias_table(weights);
+    }
+}
+
+const float* dispersal_stencil::get_cos_directions(int N_seeds) const {
+    return cos_directions.data() + static_cast<size_t>(N_seeds) * (N_seeds - 1) / 2;
+}
+
+const float* dispersal_stencil::get_sin_directions(int N_seeds) const {
+    return sin_directions.data() + static_cast<size_t>(N_seeds) * (N_seeds - 1) / 2;
+}
+
+/**
+ * @brief kernel_seed_offsets
+ * seed loop of the alternative dispersal kernels, instantiated once per kernel policy
+ */
+template <typename Kernel>
+static void kernel_seed_offsets(seed_batch& batch, const Kernel& kernel, const float* cos_directions, const float* sin_directions) {
+    for (int i = 0; i < batch.N_seeds; i++) {
+        float distance = kernel.distance(batch.uniforms[i]);
+        batch.offset_x[i] = static_cast<int>(distance * cos_directions[i]);
+        batch.offset_y[i] = static_cast<int>(distance * sin_directions[i]);
+    }
+}
+
+/**
+ * @brief dispersal_stencil::generate_offsets
+ * landing offsets of all seeds in the batch, the seed count must not exceed max_seed_production
+ * - the kernel is chosen once per tree, the seeds of the model kernel go through the vectorised
+ *   kernel in seed_trajectory.cpp, the other kernels through their own instance of kernel_seed_offsets()
+ * - with a long-distance tail all seeds are drawn from the alias table with their 64 random bits, whatever the kernel
+ */
+void dispersal_stencil::generate_offsets(seed_batch& batch) const {
+    generate_offsets(batch, detected_simd_level());
+}
+
+void dispersal_stencil::generate_offsets(seed_batch& batch, simd_level level) const {
+    if (batch.N_seeds == 0) {
+        return;
+    }
+    const float* cos_directions = get_cos_directions(batch.N_seeds);
+    const float* sin_directions = get_sin_directions(batch.N_seeds);
+    if (long_distance_share > 0) {
+        const alias_kernel tail_mixture(distance_table);
+        for (int i = 0; i < batch.N_seeds; i++) {
+            float distance = tail_mixture.distance(batch.random_bits[i]);
+            batch.offset_x[i] = static_cast<int>(distance * cos_directions[i]);
+            batch.offset_y[i] = static_cast<int>(distance * sin_directions[i]);
+        }
+        return;
+    }
+    switch (kernel) {
+    case dispersal_kernel_type::model:
+        generate_seed_offsets(batch, dispersal_factor, cos_directions, sin_directions, level);
+        break;
+    case dispersal_kernel_type::exponential:
+        kernel_seed_offsets(batch, exponential_kernel(dispersal_factor), cos_directions, sin_directions);
+        break;
+    case dispersal_kernel_type::student_2dt:
+        kernel_seed_offsets(batch, student_2dt_kernel(dispersal_factor), cos_directions, sin_directions);
+        break;
+    case dispersal_kernel_type::lognormal:
+        kernel_seed_offsets(batch, lognormal_kernel(dispersal_factor), cos_directions, sin_directions);
+        break;
+    case dispersal_kernel_type::fat_tailed:
+        kernel_seed_offsets(batch, fat_tailed_kernel(dispersal_factor, long_distance_range), cos_directions, sin_directions);
+        break;
+    }
+}
+
+/**
+ * @brief dispersal_stencil::distance
+ * dispersal distance of a seed with the random bits drawn by seed_batch::draw(), the same as generate_offsets()
+ */
+float dispersal_stencil::distance(std::uint64_t random_bits) const {
+    if (long_distance_share > 0) {
+        return alias_kernel(distance_table).distance(random_bits);
+    }
+    return distance(uniform_float(random_bits));
+}
+
+/**
+ * @brief dispersal_stencil::distance
+ * dispersal distance of a seed with the uniform u following the kernel policy without the long-distance tail,
+ * one branch per call
+ */
+float dispersal_stencil::distance(float u) const {
+    switch (kernel) {
+    case dispersal_kernel_type::exponential:
+        return exponential_kernel(dispersal_factor).distance(u);
+    case dispersal_kernel_type::student_2dt:
+        return student_2dt_kernel(dispersal_factor).distance(u);
+    case dispersal_kernel_type::lognormal:
+        return lognormal_kernel(dispersal_factor).distance(u);
+    case dispersal_kernel_type::fat_tailed:
+        return fat_tailed_kernel(dispersal_factor, long_distance_range).distance(u);
+    default:
+        return model_kernel(dispersal_factor).distance(u);
+    }
+}
+
+/**
+ * @brief dispersal_stencil::max_distance
+ * @return truncation distance of the kernel and its long-distance tail rounded up to whole patches, no seed offset is larger
+ * - the fat-tailed kernel reaches the long-distance range without a long-distance share
+ */
+int dispersal_stencil::max_distance() const {
+    if (long_distance_share > 0 || kernel == dispersal_kernel_type::fat_tailed) {
+        return std::max(local_max_distance(), long_distance_range);
+    }
+    return local_max_distance();
+}
+
+/**
+ * @brief dispersal_stencil::local_max_distance
+ * @return truncation of the thin-tailed kernels and the body of the fat-tailed kernel, e.g. for the halo of the tiled scatter,
+ *   the rarer seeds beyond it are collected separately there
+ */
+int dispersal_stencil::local_max_distance() const {
+    float max_range = kernel == dispersal_kernel_type::model ? model_kernel::max_range : kernel_max_range;
+    return static_cast<int>(std::ceil(max_range * dispersal_factor));
+}
+
+/**
+ * @brief dispersal_stencil::distance_quadrature
+ * points to integrate a function of the dispersal distance over the kernel
+ * - without a long-distance tail, the distances of the midpoints of 512 equal steps of the uniform u
+ * - with a tail, 4 points per bin of the alias table weighted with the probability of the bin,
+ *   so the rare tail is resolved as finely as the kernel
+ */
+void dispersal_stencil::distance_quadrature(std::vector<float>& distances, std::vector<double>& weights) const {
+    distances.clear();
+    weights.clear();
+    if (long_distance_share > 0) {
+        const int N_points = 4;
+        for (int k = 0; k < distance_table.size(); k++) {
+            double probability = distance_table.get_probability(k);
+            if (probability <= 0) {
+                continue;
+            }
+            for (int j = 0; j < N_points; j++) {
+                distances.push_back((k + (j + 0.5f) / N_points) * alias_kernel::bin_width);
+                weights.push_back(probability / N_points);
+            }
+        }
+        return;
+    }
+    const int N_quadrature = 512;
+    for (int q = 0; q < N_quadrature; q++) {
+        distances.push_back(distance((q + 0.5f) / N_quadrature));
+        weights.push_back(1.0 / N_quadrature);
+    }
+}
+
+int map_reach(int x_size, int y_size) {
+    return static_cast<int>(std::ceil(std::hypot(x_size, y_size)));
+}
+
+/**
+ * @brief dispersal_stencil_set::build
+ * takes the species parameters of the first birch and the first oak tree, all trees of a species share them
+ * - seeds thrown further than the map diagonal never land on the map, so long-distance ranges beyond max_reach
+ *   would only grow the alias tables, the expected seed stencils and their FFT padding
+ * @param birch dispersal kernel and long-distance tail of the birch trees
+ * @param oak dispersal kernel and long-distance tail of the oak trees
+ * @param max_reach largest long-distance range in patches, 0 keeps the ranges of the settings
+ */
+void dispersal_stencil_set::build(const std::vector<tree>& trees, dispersal_settings birch, dispersal_settings oak, int max_reach) {
+    dispersal_settings settings[N_species] = {birch, oak};          // further species use the default settings
+    if (max_reach > 0) {
+        for (dispersal_settings& species_settings : settings) {
+            species_settings.long_distance_range = std::min(species_settings.long_distance_range, max_reach);
+        }
+    }
+    bool built[N_species] = {};
+    for (auto& t : trees) {
+        int s = species_index(t.species);
+        if (built[s] == false) {
+            stencils[s] = dispersal_stencil(t.dispersal_factor, t.max_seed_production, settings[s]);
+            built[s] = true;
+        }
+    }
+}
+
+int dispersal_stencil_set::max_distance() const {
+    int distance = 0;
+    for (const dispersal_stencil& stencil : stencils) {
+        distance = std::max(distance, stencil.max_distance());
+    }
+    return distance;
+}
+
+int dispersal_stencil_set::local_max_distance() const {
+    int distance = 0;
+    for (const dispersal_stencil& stencil : stencils) {
+        distance = std::max(distance, stencil.local_max_distance());
+    }
+    return distance;
+}
+
+const dispersal_stencil& dispersal_stencil_set::for_species(char species) const {
+    return stencils[species_index(species)];
+}
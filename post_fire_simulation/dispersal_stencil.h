@@ -0,0 +1,87 @@
+#ifndef DISPERSAL_STENCIL_H
+#define DISPERSAL_STENCIL_H
+
+#include "tree.h"
+#include "alias_table.h"
+#include "dispersal_kernel.h"
+#include "seed_trajectory.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The dispersal_settings struct
+ * dispersal options of one species chosen in the ui, the share of seeds in the long-distance tail is 0 by default
+ */
+struct dispersal_settings {
+    dispersal_settings(dispersal_kernel_type kernel = dispersal_kernel_type::model,
+                       float long_distance_share = 0, int long_distance_range = 0)
+        : kernel(kernel), long_distance_share(long_distance_share), long_distance_range(long_distance_range) {}
+
+    dispersal_kernel_type kernel;
+    float long_distance_share;          // share of the seeds drawn from the long_distance_kernel
+    int long_distance_range;            // largest long-distance dispersal distance in patches, also the end of the fat-tailed kernel
+};
+
+/**
+ * @brief The dispersal_stencil class
+ * Everything needed to turn the uniforms of a tree's seeds into landing offsets for one species.
+ * The seed direction 2 * pi * i / N_seeds only depends on the seed count, which is below max_seed_production,
+ * so all directions are tabulated once at setup and the hot loop does no transcendental calls.
+ * The distances follow the dispersal kernel of the species, see dispersal_kernel.h. With a long-distance tail
+ * the distances of the kernel and the tail are mixed in an alias table, so a seed costs the same for any share
+ * and range of the tail.
+ */
+class dispersal_stencil {
+public:
+    // Constructors
+    dispersal_stencil();
+    dispersal_stencil(int dispersal_factor, int max_seed_production, dispersal_settings settings = dispersal_settings());
+
+    // Member functions
+    void generate_offsets(seed_batch& batch) const;                     // offsets of all seeds in the batch with the fastest kernel
+    void generate_offsets(seed_batch& batch, simd_level level) const;   // forces an instruction set, e.g. for tests
+    float distance(std::uint64_t random_bits) const;                    // dispersal distance of a seed with the bits of seed_batch::draw()
+    float distance(float u) const;                                      // distance of the kernel without the tail for a uniform u, for setup and tests
+    int max_distance() const;                                           // largest possible seed offset in patches
+    int local_max_distance() const;                                     // largest seed offset without the long-distance and power-law tails
+    void distance_quadrature(std::vector<float>& distances,             // distances and their probabilities to integrate
+                             std::vector<double>& weights) const;       // over the kernel, e.g. for the expected seed rain
+    const float* get_cos_directions(int N_seeds) const;                 // directions of seeds 1 .. N_seeds of a tree throwing N_seeds seeds
+    const float* get_sin_directions(int N_seeds) const;
+
+    // Member variables
+    int dispersal_factor = 0;
+    int max_seed_production = 0;
+    dispersal_kernel_type kernel = dispersal_kernel_type::model;
+    float long_distance_share = 0;
+    int long_distance_range = 0;
+
+private:
+    alias_table distance_table;         // distance bins of the kernel mixed with the long-distance tail, built if the share is above 0
+    // triangular tables, the N_seeds directions of a tree throwing N_seeds seeds start at N_seeds * (N_seeds - 1) / 2
+    std::vector<float> cos_directions;
+    std::vector<float> sin_directions;
+};
+
+// longest seed offset that can still land on a map of the given extent, its diagonal rounded up to whole patches
+int map_reach(int x_size, int y_size);
+
+/**
+ * @brief The dispersal_stencil_set class
+ * one dispersal stencil per species, built from the trees at setup
+ */
+class dispersal_stencil_set {
+public:
+    void build(const std::vector<tree>& trees,                  // stencils for the parameters of the birch and oak trees
+               dispersal_settings birch = dispersal_settings(),
+               dispersal_settings oak = dispersal_settings(),
+               int max_reach = 0);                              // long-distance ranges are clamped to it, e.g. map_reach(), 0 for no limit
+    const dispersal_stencil& for_species(char species) const;   // 'b' for birch, 'o' for oak
+    int max_distance() const;                                   // largest seed offset of all species
+    int local_max_distance() const;                             // largest seed offset of all species without the long-distance and power-law tails
+
+private:
+    dispersal_stencil stencils[N_species];                      // same order as model_species, first element is birch, second is oak
+};
+
+#endif // DISPERSAL_STENCIL_H
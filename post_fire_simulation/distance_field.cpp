@@ -0,0 +1,209 @@
+/**
+ * DISTANCE FIELD
+ */
+
+#include "distance_field.h"
+#include "distance_transform.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+static const long long no_site = std::numeric_limits<long long>::max();
+
+/**
+ * @brief distance_field::build
+ * starts from the distance transform of all trees, the first take_changed_patches() then returns every patch
+ */
+void distance_field::build(const std::vector<tree>& trees, int x_size, int y_size, int block_size) {
+    this->x_size = x_size;
+    this->y_size = y_size;
+    this->block_size = std::max(block_size, 1);
+    N_blocks_x = (x_size + this->block_size - 1) / this->block_size;
+    N_blocks_y = (y_size + this->block_size - 1) / this->block_size;
+
+    N_trees_on_patch.assign(x_size * y_size, 0);
+    std::vector<char> is_tree(x_size * y_size, 0);
+    for (auto& t : trees) {
+        const int i = t.x_y_cor[0] * y_size + t.x_y_cor[1];
+        N_trees_on_patch[i]++;
+        is_tree[i] = 1;
+    }
+    squared_distances = squared_distance_transform(is_tree, x_size, y_size);
+    for (auto& d : squared_distances) {
+        d = d < 0 ? no_site : d;
+    }
+
+    block_sites.assign(N_blocks_x * N_blocks_y, {});
+    for (int i = 0; i < x_size * y_size; i++) {
+        if (is_tree[i]) {
+            block_sites[(i / y_size / this->block_size) * N_blocks_y + (i % y_size) / this->block_size].push_back(i);
+        }
+    }
+    block_max.assign(N_blocks_x * N_blocks_y, 0);
+    for (int b = 0; b < N_blocks_x * N_blocks_y; b++) {
+        update_block_max(b);
+    }
+
+    is_changed.assign(x_size * y_size, 1);
+    changed_patches.resize(x_size * y_size);
+    for (int i = 0; i < x_size * y_size; i++) {
+        changed_patches[i] = i;
+    }
+}
+
+int distance_field::size() const {
+    return static_cast<int>(squared_distances.size());
+}
+
+long long distance_field::squared_distance(int i) const {
+    return squared_distances[i] == no_site ? -1 : squared_distances[i];
+}
+
+float distance_field::distance(int i) const {
+    if (squared_distances[i] == no_site) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return std::sqrt(static_cast<double>(squared_distances[i]));
+}
+
+std::vector<int> distance_field::take_changed_patches() {
+    std::vector<int> changed;
+    changed.swap(changed_patches);
+    std::sort(changed.begin(), changed.end());
+    for (int i : changed) {
+        is_changed[i] = 0;
+    }
+    return changed;
+}
+
+void distance_field::mark_changed(int i) {
+    if (!is_changed[i]) {
+        is_changed[i] = 1;
+        changed_patches.push_back(i);
+    }
+}
+
+// squared distance from (x, y) to the closest patch of the block
+long long distance_field::squared_distance_to_block(int block, int x, int y) const {
+    const int x_min = (block / N_blocks_y) * block_size;
+    const int y_min = (block % N_blocks_y) * block_size;
+    const int x_max = std::min(x_min + block_size, x_size) - 1;
+    const int y_max = std::min(y_min + block_size, y_size) - 1;
+    const long long dx = std::max(std::max(x_min - x, x - x_max), 0);
+    const long long dy = std::max(std::max(y_min - y, y - y_max), 0);
+    return dx * dx + dy * dy;
+}
+
+void distance_field::update_block_max(int block) {
+    const int x_min = (block / N_blocks_y) * block_size;
+    const int y_min = (block % N_blocks_y) * block_size;
+    long long max_distance = 0;
+    for (int x = x_min; x < std::min(x_min + block_size, x_size); x++) {
+        for (int y = y_min; y < std::min(y_min + block_size, y_size); y++) {
+            max_distance = std::max(max_distance, squared_distances[x * y_size + y]);
+        }
+    }
+    block_max[block] = max_distance;
+}
+
+/**
+ * @brief distance_field::nearest_squared_distance
+ * every occupied patch in block ring r or further out is at least (r - 1) * block_size + 1 patches away,
+ * the search stops once the best distance is below that, as in tree_index::nearest()
+ */
+long long distance_field::nearest_squared_distance(int x, int y) const {
+    const int bx = x / block_size;
+    const int by = y / block_size;
+    const int max_ring = std::max(std::max(bx, N_blocks_x - 1 - bx), std::max(by, N_blocks_y - 1 - by));
+    long long best = no_site;
+    for (int ring = 0; ring <= max_ring; ring++) {
+        const long long bound = static_cast<long long>(ring - 1) * block_size + 1;
+        if (best != no_site && best < bound * bound) {
+            break;
+        }
+        for (int i = std::max(bx - ring, 0); i <= std::min(bx + ring, N_blocks_x - 1); i++) {
+            const bool edge_column = i == bx - ring || i == bx + ring;
+            const int step = edge_column ? 1 : 2 * ring;               // inner columns only have their top and bottom block in the ring
+            for (int j = by - ring; j <= by + ring; j += std::max(step, 1)) {
+                if (j < 0 || j >= N_blocks_y) {
+                    continue;
+                }
+                for (int site : block_sites[i * N_blocks_y + j]) {
+                    const long long dx = site / y_size - x;
+                    const long long dy = site % y_size - y;
+                    best = std::min(best, dx * dx + dy * dy);
+                }
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief distance_field::add_tree
+ * a new tree can only shorten distances, and only in blocks that are closer to it than their largest distance
+ */
+void distance_field::add_tree(int x, int y) {
+    const int site = x * y_size + y;
+    if (N_trees_on_patch[site]++ > 0) {
+        return;                                                 // the patch was occupied already, no distance changes
+    }
+    block_sites[(x / block_size) * N_blocks_y + y / block_size].push_back(site);
+    for (int b = 0; b < N_blocks_x * N_blocks_y; b++) {
+        if (squared_distance_to_block(b, x, y) >= block_max[b]) {
+            continue;
+        }
+        const int x_min = (b / N_blocks_y) * block_size;
+        const int y_min = (b % N_blocks_y) * block_size;
+        for (int i = x_min; i < std::min(x_min + block_size, x_size); i++) {
+            for (int j = y_min; j < std::min(y_min + block_size, y_size); j++) {
+                const long long d = static_cast<long long>(i - x) * (i - x) + static_cast<long long>(j - y) * (j - y);
+                if (d < squared_distances[i * y_size + j]) {
+                    squared_distances[i * y_size + j] = d;
+                    mark_changed(i * y_size + j);
+                }
+            }
+        }
+        update_block_max(b);
+    }
+}
+
+/**
+ * @brief distance_field::remove_tree
+ * only patches whose distance equals their distance to the removed tree can change, and those lie in
+ * blocks whose largest distance reaches the tree, their new distance comes from the remaining trees
+ */
+void distance_field::remove_tree(int x, int y) {
+    const int site = x * y_size + y;
+    if (N_trees_on_patch[site] == 0 || --N_trees_on_patch[site] > 0) {
+        return;                                                 // another tree still stands on the patch
+    }
+    std::vector<int>& sites = block_sites[(x / block_size) * N_blocks_y + y / block_size];
+    sites.erase(std::find(sites.begin(), sites.end(), site));
+    for (int b = 0; b < N_blocks_x * N_blocks_y; b++) {
+        if (squared_distance_to_block(b, x, y) > block_max[b]) {
+            continue;
+        }
+        const int x_min = (b / N_blocks_y) * block_size;
+        const int y_min = (b % N_blocks_y) * block_size;
+        bool block_changed = false;
+        for (int i = x_min; i < std::min(x_min + block_size, x_size); i++) {
+            for (int j = y_min; j < std::min(y_min + block_size, y_size); j++) {
+                const long long d = static_cast<long long>(i - x) * (i - x) + static_cast<long long>(j - y) * (j - y);
+                if (d != squared_distances[i * y_size + j]) {
+                    continue;
+                }
+                const long long new_distance = nearest_squared_distance(i, j);
+                if (new_distance != d) {
+                    squared_distances[i * y_size + j] = new_distance;
+                    mark_changed(i * y_size + j);
+                    block_changed = true;
+                }
+            }
+        }
+        if (block_changed) {
+            update_block_max(b);
+        }
+    }
+}
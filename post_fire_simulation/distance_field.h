@@ -0,0 +1,44 @@
+#ifndef DISTANCE_FIELD_H
+#define DISTANCE_FIELD_H
+
+#include "tree.h"
+#include <vector>
+
+/**
+ * @brief The distance_field class
+ * Distance of every patch to the nearest tree that is kept up to date while trees are added or removed.
+ * The map is split into blocks of block_size * block_size patches that know their occupied patches and
+ * their largest distance, so an update only visits the blocks its tree can reach instead of the whole map.
+ * Patches whose distance changed are collected until take_changed_patches() is called.
+ */
+class distance_field {
+public:
+    // Member functions
+    void build(const std::vector<tree>& trees, int x_size, int y_size, int block_size = 16);   // full distance transform, marks all patches as changed
+    void add_tree(int x, int y);
+    void remove_tree(int x, int y);
+    long long squared_distance(int i) const;    // squared distance of patch i to the nearest tree, -1 if there are no trees
+    float distance(int i) const;                // same values as distance_to_nearest_tree(), infinite if there are no trees
+    std::vector<int> take_changed_patches();   // patches whose distance changed since the last call, in index order
+    int size() const;
+
+private:
+    long long squared_distance_to_block(int block, int x, int y) const;
+    long long nearest_squared_distance(int x, int y) const;    // search of the occupied patches, block rings around (x, y)
+    void update_block_max(int block);
+    void mark_changed(int i);
+
+    int x_size = 0;
+    int y_size = 0;
+    int block_size = 1;
+    int N_blocks_x = 0;
+    int N_blocks_y = 0;
+    std::vector<long long> squared_distances;      // per patch, no_site while there are no trees
+    std::vector<int> N_trees_on_patch;             // several trees may stand on the same patch
+    std::vector<std::vector<int>> block_sites;     // occupied patches of each block
+    std::vector<long long> block_max;              // largest squared distance within each block
+    std::vector<char> is_changed;
+    std::vector<int> changed_patches;
+};
+
+#endif // DISTANCE_FIELD_H
@@ -0,0 +1,99 @@
+/**
+ * DISTANCE TRANSFORM
+ */
+
+#include "distance_transform.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief lower_envelope
+ * 1D squared distance transform of the sampled function f along one row of the grid
+ * - the parabolas (q - p)^2 + f(p) of all p with a finite f(p) form a lower envelope, the vertex
+ *   positions v and the boundaries z between neighbouring parabolas are built left to right
+ * - the envelope is then read off at every q, each parabola is added and removed at most once
+ * @param f first value of the row, the values are stride apart and overwritten with the transform
+ * @param N number of values in the row
+ * @param no_site value of points without a parabola
+ * @param values, v, z work buffers of at least N, N and N + 1 elements
+ */
+static void lower_envelope(long long* f, int N, int stride, long long no_site, std::vector<long long>& values,
+                           std::vector<int>& v, std::vector<double>& z) {
+    for (int q = 0; q < N; q++) {
+        values[q] = f[q * stride];
+    }
+    int k = -1;                                                         // index of the rightmost parabola of the envelope
+    for (int q = 0; q < N; q++) {
+        if (values[q] == no_site) {
+            continue;
+        }
+        double s = 0;
+        while (k >= 0) {
+            const int p = v[k];
+            // intersection of the parabolas with vertices at p and q
+            s = ((values[q] + static_cast<double>(q) * q) - (values[p] + static_cast<double>(p) * p)) / (2.0 * (q - p));
+            if (s > z[k]) {
+                break;
+            }
+            k--;
+        }
+        k++;
+        v[k] = q;
+        z[k] = k == 0 ? -HUGE_VAL : s;
+        z[k + 1] = HUGE_VAL;
+    }
+    if (k < 0) {
+        return;                                                         // no site in this row, f stays no_site
+    }
+    int j = 0;
+    for (int q = 0; q < N; q++) {
+        while (z[j + 1] < q) {
+            j++;
+        }
+        const long long d = q - v[j];
+        f[q * stride] = d * d + values[v[j]];
+    }
+}
+
+/**
+ * @brief squared_distance_transform
+ * exact squared Euclidean distances in integers, first along y within every x column, then along x
+ */
+std::vector<long long> squared_distance_transform(const std::vector<char>& is_site, int x_size, int y_size) {
+    const long long no_site = -1;
+    std::vector<long long> distance(is_site.size());
+    for (size_t i = 0; i < is_site.size(); i++) {
+        distance[i] = is_site[i] ? 0 : no_site;
+    }
+
+    const int N_max = std::max(x_size, y_size);
+    std::vector<long long> values(N_max);
+    std::vector<int> v(N_max);
+    std::vector<double> z(N_max + 1);
+    for (int x = 0; x < x_size; x++) {
+        lower_envelope(&distance[x * y_size], y_size, 1, no_site, values, v, z);
+    }
+    for (int y = 0; y < y_size; y++) {
+        lower_envelope(&distance[y], x_size, y_size, no_site, values, v, z);
+    }
+    return distance;
+}
+
+/**
+ * @brief distance_to_nearest_tree
+ * replaces the distance of every patch to every tree, O(patches) instead of O(patches * trees)
+ * - the squared distances are exact integers, so the float distances equal the brute force ones
+ */
+std::vector<float> distance_to_nearest_tree(const std::vector<tree>& trees, int x_size, int y_size) {
+    std::vector<char> is_tree(x_size * y_size, 0);
+    for (auto& t : trees) {
+        is_tree[t.x_y_cor[0] * y_size + t.x_y_cor[1]] = 1;
+    }
+    std::vector<long long> squared_distance = squared_distance_transform(is_tree, x_size, y_size);
+    std::vector<float> distance(squared_distance.size());
+    for (size_t i = 0; i < distance.size(); i++) {
+        distance[i] = std::sqrt(static_cast<double>(squared_distance[i]));
+    }
+    return distance;
+}
@@ -0,0 +1,19 @@
+#ifndef DISTANCE_TRANSFORM_H
+#define DISTANCE_TRANSFORM_H
+
+#include "tree.h"
+#include <vector>
+
+/**
+ * Exact Euclidean distance transform of Felzenszwalb and Huttenlocher (2012): the squared distance to the nearest
+ * site is the lower envelope of parabolas, computed in one pass along y and one along x, O(patches) in total.
+ * Grids use the index x * y_size + y of patch_grid::index().
+ */
+
+// squared distance of every patch to the nearest patch with is_site != 0, -1 everywhere if there is no site
+std::vector<long long> squared_distance_transform(const std::vector<char>& is_site, int x_size, int y_size);
+
+// distance of every patch to the nearest tree, burnt or not, same values as sqrt(dx^2 + dy^2) to every tree
+std::vector<float> distance_to_nearest_tree(const std::vector<tree>& trees, int x_size, int y_size);
+
+#endif // DISTANCE_TRANSFORM_H
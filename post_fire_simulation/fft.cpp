@@ -0,0 +1,90 @@
+/**
+ * FAST FOURIER TRANSFORM
+ */
+
+#include "fft.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief next_power_of_two
+ * @return smallest power of two that is greater than or equal to n
+ */
+int next_power_of_two(int n) {
+    int p = 1;
+    while (p < n) {
+        p *= 2;
+    }
+    return p;
+}
+
+/**
+ * @brief fft
+ * iterative Cooley-Tukey transform: bit reversal permutation followed by log2(N) butterfly passes
+ * @param data complex values, size must be a power of two
+ * @param inverse true for the inverse transform, which is normalized by 1/N
+ */
+void fft(std::vector<std::complex<double>>& data, bool inverse) {
+    const int n = static_cast<int>(data.size());
+
+    // bit reversal permutation
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+
+    // butterflies of doubling length
+    for (int length = 2; length <= n; length *= 2) {
+        double angle = 2 * M_PI / length * (inverse ? 1 : -1);
+        std::complex<double> root(cos(angle), sin(angle));
+        for (int i = 0; i < n; i += length) {
+            std::complex<double> w(1);
+            for (int j = 0; j < length / 2; j++) {
+                std::complex<double> u = data[i + j];
+                std::complex<double> v = data[i + j + length / 2] * w;
+                data[i + j] = u + v;
+                data[i + j + length / 2] = u - v;
+                w *= root;
+            }
+        }
+    }
+
+    if (inverse) {
+        for (auto& value : data) {
+            value /= n;
+        }
+    }
+}
+
+/**
+ * @brief fft_2d
+ * 2D transform as 1D transforms over all rows followed by all columns
+ * @param data nx * ny complex values stored with index x * ny + y, both sizes powers of two
+ */
+void fft_2d(std::vector<std::complex<double>>& data, int nx, int ny, bool inverse) {
+    std::vector<std::complex<double>> line(ny);
+    for (int x = 0; x < nx; x++) {                      // transform along y, contiguous in memory
+        std::copy(data.begin() + x * ny, data.begin() + (x + 1) * ny, line.begin());
+        fft(line, inverse);
+        std::copy(line.begin(), line.end(), data.begin() + x * ny);
+    }
+    line.resize(nx);
+    for (int y = 0; y < ny; y++) {                      // transform along x
+        for (int x = 0; x < nx; x++) {
+            line[x] = data[x * ny + y];
+        }
+        fft(line, inverse);
+        for (int x = 0; x < nx; x++) {
+            data[x * ny + y] = line[x];
+        }
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <vector>
+
+/**
+ * Radix-2 fast Fourier transforms used by the convolution based dispersal in seed_rain_field.
+ * All sizes must be powers of two, the inverse transforms include the 1/N normalization.
+ */
+
+int next_power_of_two(int n);                                                       // smallest power of two >= n
+
+void fft(std::vector<std::complex<double>>& data, bool inverse);                   // in-place 1D transform
+void fft_2d(std::vector<std::complex<double>>& data, int nx, int ny, bool inverse); // in-place 2D transform, index x * ny + y
+
+#endif // FFT_H
@@ -90,10 +90,20 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "patch.h"
+#include "patch_grid.h"
 #include "tree.h"
+#include "dispersal.h"
+#include "distance_field.h"
+#include "mean_field_populations.h"
+#include "seed_rain_field.h"
+#include "sim_random.h"
+#include "tree_index.h"
+#include "year_step.h"
 
 // include necessary libraries
 #include <QImage>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <random>
 #include <vector>
@@ -104,15 +114,18 @@
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , population_analysis([this](const patch_grid& snapshot, int) {
+          store_totals(count_totals(snapshot));     // only the consumer thread writes the chart vectors until population_analysis.wait()
+      })
 {
     ui->setupUi(this);
     int number_of_simulation_years = 1;
 
     // initialize population vectors with the desired size
-    birch_pop_total.resize(number_of_simulation_years, std::vector<int>(5, 0));
-    oak_pop_total.resize(number_of_simulation_years, std::vector<int>(5, 0));
-    birch_pop_burnt_area_total.resize(number_of_simulation_years, std::vector<int>(5, 0));
-    oak_pop_burnt_area_total.resize(number_of_simulation_years, std::vector<int>(5, 0));
+    for (int j = 0; j < N_species; j++) {
+        pop_total[j].resize(number_of_simulation_years, stage_totals{});
+        pop_burnt_area_total[j].resize(number_of_simulation_years, stage_totals{});
+    }
 
     // birch population charts
     N_birch_pop_chart = new QChart();                               // initialize the chart
@@ -149,12 +162,9 @@ const int area_to_ha_conv_factor = x_size * y_size / 10000;               // con
 const int patch_edge_m = 5;                                               // size of a patch  in meters
 const int pixel_to_ha_conv_factor = 10000 / (patch_edge_m * patch_edge_m);  // conversion factor from pixels to hectares for population density
 
-// declaration of random number generators
-std::random_device rd;                                              // used to obtain a seed for the random number engine
-std::mt19937 gen(rd());                                             // standard mersenne_twister_engine seeded with rd()
-std::uniform_int_distribution<int> rand_x_cor(0, x_size - 1);       // random x coordinate
-std::uniform_int_distribution<int> rand_y_cor(0, y_size - 1);       // random y coordinate in case of rectangular map
-std::uniform_real_distribution<float> rand_float_01(0.0f, 1.0f);    // random float between 0 and 1 for dispersal distance and seedling survival
+// random numbers: every procedure draws from philox4x32 streams keyed by the run seed, the year and the patch or tree id,
+// see sim_random.h, so a run is reproduced from its seed alone, whatever the number of threads
+std::random_device rd;                                              // used to obtain a run seed if none is given in the ui
 
 /**
  * @brief MainWindow::on_setup_button_clicked
@@ -169,6 +179,7 @@ void MainWindow::on_setup_button_clicked()
     setup_trees();                  // create the trees
     setup_burnt_area();             // create the burnt area if checkbox was activated
     setup_min_distance_to_tree();   // calculate the minimum distance to the closest tree for each patch
+    setup_dispersal();              // prepare the selected dispersal mode for the final set of trees
     count_populations();            // count the populations of seeds in each patch (0 at beginning)
     clear_charts();                 // clear the population charts
     update_map();                   // update the map drawing
@@ -189,12 +200,31 @@ void MainWindow::on_go_button_clicked()
     }
     // get the number of years to simulate from the ui spin box
     // perform the annual procedures
+    // counting of year t on a consumer thread from a snapshot of the patches while year t + 1 is simulated,
+    // the expected values are counted from the mean field and the fused pass counts within its pass
+    const bool fused = selected_year_step == year_step_mode::fused_pass && selected_demography_mode != demography_mode::expected_values;
+    const bool pipelined = pipelined_analysis && !fused && selected_demography_mode != demography_mode::expected_values;
     for(int i = 0; i < number_of_simulation_years; ++i){
-        perform_dispersal();        // seeds dispersal per tree
-        perform_pop_dynamics();     // seed and sapling population dynamics according to matrix model
-        count_populations();        // count the populations of seeds in each patch
+        if (fused) {
+            perform_fused_year();   // the three procedures below in one pass over the patches, same result
+        } else {
+            perform_dispersal();        // seeds dispersal per tree
+            perform_pop_dynamics();     // seed and sapling population dynamics according to matrix model
+            if (pipelined) {
+                submit_populations();       // counted while the next year is simulated
+            } else {
+                count_populations();        // count the populations of seeds in each patch
+            }
+        }
+        simulated_year++;           // next year draws from the next streams
         ui->progress_output_textEdit->append("simulated year " + QString::number(i+1) + " out of " + QString::number(number_of_simulation_years) + " years");
+        // intermediate frames only at the interval selected in the ui, the simulation itself never draws
+        if (render_interval > 0 && (i + 1) % render_interval == 0 && i + 1 < number_of_simulation_years) {
+            update_map();
+            QCoreApplication::processEvents();  // show the frame while the simulation continues
+        }
     }
+    population_analysis.wait();     // the counts of the last year are in the chart vectors
     update_map();                   // update the map drawing
     draw_charts();                  // after simulation, draw the population charts for birch and oak
 }
@@ -205,9 +235,30 @@ void MainWindow::on_go_button_clicked()
  */
 void MainWindow::setup_map() {
     scene = new QGraphicsScene;
+    map_item = nullptr;             // the map of the previous setup belongs to the old scene
     // and hook the scene to main_map
     ui->main_map->setScene(scene);
     number_of_simulation_years = ui->N_years_spinBox->value();      // set the number of simulation years to the value of the ui spinbox
+    selected_dispersal_mode = static_cast<dispersal_mode>(ui->dispersal_mode_comboBox->currentIndex()); // dispersal engine, see dispersal.h
+    N_threads = ui->threads_spinBox->value();                       // number of threads used by the parallel procedures
+    workers.resize(N_threads);
+    int long_distance_range = ui->long_distance_range_spinBox->value();    // dispersal kernel and long-distance tail per species
+    birch_dispersal = dispersal_settings(static_cast<dispersal_kernel_type>(ui->birch_kernel_comboBox->currentIndex()),
+                                         ui->birch_long_distance_spinBox->value() / 100, long_distance_range);
+    oak_dispersal = dispersal_settings(static_cast<dispersal_kernel_type>(ui->oak_kernel_comboBox->currentIndex()),
+                                       ui->oak_long_distance_spinBox->value() / 100, long_distance_range);
+    render_interval = ui->render_interval_spinBox->value();        // years between map updates during a run
+    selected_light_model = static_cast<light_model>(ui->light_model_comboBox->currentIndex());    // light from the nearest tree or from all canopy trees
+    selected_demography_mode = static_cast<demography_mode>(ui->demography_mode_comboBox->currentIndex());  // per individual or binomial cohort draws
+    selected_year_step = static_cast<year_step_mode>(ui->year_step_comboBox->currentIndex());  // separate passes or one fused pass per year
+    pipelined_analysis = ui->pipelined_analysis_checkBox->isChecked();    // count on a consumer thread while the next year is simulated
+    population_analysis.reset();                                    // the next snapshot copies the environment of this setup
+    run_seed = ui->seed_spinBox->value();                           // 0 draws a new run seed
+    if (run_seed == 0) {
+        run_seed = std::uniform_int_distribution<int>(1, ui->seed_spinBox->maximum())(rd);
+    }
+    ui->progress_output_textEdit->append("Random seed: " + QString::number(run_seed));  // enter it in the ui to repeat this run
+    simulated_year = 0;
 
     // declare and initialize an image
     ui->main_map->resize(x_size, y_size);
@@ -219,17 +270,25 @@ void MainWindow::setup_map() {
 /**
  * @brief MainWindow::setup_trees
  * Function to place the trees on the map and assign species according to the user selected ratio of birch to oak
+ * - the tree positions are indexed for neighbourhood queries, see tree_index.cpp
+ * - the distance of every patch to the nearest tree is set up once here and then only updated
+ *   around trees that are removed or added, see distance_field.cpp
  */
 std::vector<tree> trees;        // vector of tree objects
+tree_index tree_locations;      // spatial index of the trees, rebuilt whenever trees are removed
+distance_field tree_distances;  // distance of each patch to the nearest tree, updated whenever trees are removed or added
 void MainWindow::setup_trees() {
     trees.clear();
     N_trees = ui->N_trees_spinBox->value() * area_to_ha_conv_factor; // get the number of trees from the ui spinbox, multiply by factor to scale to ha
     float species_ratio = ui->species_ratio_spinBox->value();
     int N_birch_trees = N_trees * (1 - species_ratio);
+    std::uniform_int_distribution<int> rand_x_cor(0, x_size - 1);       // random x coordinate
+    std::uniform_int_distribution<int> rand_y_cor(0, y_size - 1);       // random y coordinate in case of rectangular map
     // loop over the number of trees
     for (int i = 0; i < N_trees; ++i) {
+        philox4x32 tree_gen(run_seed, random_purpose::tree_placement, 0, i);   // stream of this tree
         trees.emplace_back(i, std::vector<int>{}, 'b', 1, 10);  // create dummy tree object
-        trees[i].x_y_cor = {rand_x_cor(gen), rand_y_cor(gen)};          // assign random x and y coordinates
+        trees[i].x_y_cor = {rand_x_cor(tree_gen), rand_y_cor(tree_gen)};    // assign random x and y coordinates
         if (i < N_birch_trees){                                 // assign birch based on species_ratio
             trees[i].species = 'b';                             // birch
             trees[i].update_species_params();                   // update species parameters
@@ -241,26 +300,22 @@ void MainWindow::setup_trees() {
         }
         trees[i].id = i;                                        // assign tree id
     }
+    tree_locations.build(trees, x_size, y_size);
+    tree_distances.build(trees, x_size, y_size);
     scene->addPixmap(QPixmap::fromImage(image));                // update the map
 }
 
 /**
  * @brief MainWindow::setup_patches
  *  Patch setup procedure
-    - clear the patches vector
-    - loop over the x and y coordinates and create the according patch_id
-    - create the patch object and add it to the patches vector
+    - clear the patch grid
+    - create one patch object per pixel, stored in fixed x/y order so patches can be looked up by coordinates
  */
-std::vector<patch> patches; // vector of patch objects
+patch_grid patches; // grid of patch objects
+transition_factors pop_factors;     // mortality and growth factors of all patches, recomputed only after the environment changed
 void MainWindow::setup_patches() {
-    patches.clear();
-
-    for (int i = 0; i < x_size; i++) {
-        for (int j = 0; j < y_size; j++) {
-            std::string patch_id = std::to_string(i) + "_" + std::to_string(j);
-            patches.emplace_back(patch_id, std::vector<int>{i, j}, std::vector<int>{0, 0});
-        }
-    }
+    patches.reset(x_size, y_size);
+    pop_factors.invalidate();
 }
 
 
@@ -294,6 +349,7 @@ void MainWindow::setup_burnt_area(){
             for (int j = y_center - radius; j <= y_center + radius; j++) {
                 if ((i - x_center) * (i - x_center) + (j - y_center) * (j - y_center) <= radius * radius) {
                     image.setPixel(i, j, color_burnt_area);
+                    patches.at(i, j).set_burnt();   // set burnt status of the patch directly via its coordinates
                     N_burnt_patches++; // increment the number of burnt patches
                 }
             }
@@ -306,22 +362,26 @@ void MainWindow::setup_burnt_area(){
         bool deadwood_removed = ui->deadwood_removed_checkBox->isChecked(); // update if burnt trees are removed after fire
         int N_burnt_trees = 0;  // counter to print number of trees burnt after fire
 
-        for (size_t i = 0; i < trees.size(); ++i) {
-            if (image.pixel(trees[i].x_y_cor[0], trees[i].x_y_cor[1]) == color_burnt_area) {
-                if (deadwood_removed) {
-                    trees.erase(trees.begin() + static_cast<int>(i));
-                    --i;
-                } else {
-                    trees[i].set_burnt(); // set tree status to burnt, can therefore not disperse seeds anymore, but will still influence the light availability
-                    N_burnt_trees++;
+        // trees standing on the burnt circle, found through the spatial index instead of checking every tree
+        std::vector<int> burnt_trees = tree_locations.within_radius(x_center, y_center, radius);
+        if (deadwood_removed) {
+            std::vector<char> removed(trees.size(), 0);
+            for (int i : burnt_trees) {
+                removed[i] = 1;
+                tree_distances.remove_tree(trees[i].x_y_cor[0], trees[i].x_y_cor[1]);
+            }
+            size_t N_kept = 0;                                  // keep the remaining trees in their order
+            for (size_t i = 0; i < trees.size(); ++i) {
+                if (!removed[i]) {
+                    trees[N_kept++] = trees[i];
                 }
             }
-        }
-
-        // loop over patches to set burnt status according to color assigned previously
-        for (auto& p : patches){
-            if (image.pixel(p.x_y_cor[0], p.x_y_cor[1]) == color_burnt_area){
-                p.set_burnt();
+            trees.erase(trees.begin() + static_cast<long>(N_kept), trees.end());
+            tree_locations.build(trees, x_size, y_size);        // positions in the tree vector have changed
+        } else {
+            for (int i : burnt_trees) {
+                trees[i].set_burnt(); // set tree status to burnt, can therefore not disperse seeds anymore, but will still influence the light availability
+                N_burnt_trees++;
             }
         }
 
@@ -335,78 +395,115 @@ void MainWindow::setup_burnt_area(){
 /**
  * @brief MainWindow::setup_min_distance_to_tree
  * Function to calculate the minimum euclidean distance between each patch and the closest tree
- * - loop over the patches and calculate the distance to each tree
+ * - the distances come from the distance field of the trees, see distance_field.cpp, instead of
+ *   measuring the distance from every patch to every tree
+ * - only patches whose distance changed since the last call are updated: all patches after setup_trees(),
+ *   afterwards only the surroundings of removed or added trees
  * - store the minimum distance in the patch object
+ * - with the canopy shading light model, light availability is 1 minus the shading summed over all trees,
+ *   computed by box filters in one pass over the map, see canopy_shading.cpp
  */
 void MainWindow::setup_min_distance_to_tree() {
     if (trees.empty()) {                                        // check if there are any trees to compute distance to
         std::cerr << "Error: No trees to compute distance to" << std::endl;
         return;
     } else {                                                    // if there are trees, compute the distance to each patch
-        for (auto& p : patches) {
-            std::vector<float> distances(trees.size(), 0.0f);   // initialize distances with 0 for each patch
-
-            for (unsigned int i = 0; i < trees.size(); i++) {   // loop over the trees
-                float distance = sqrt(pow(trees[i].x_y_cor[0] - p.x_y_cor[0], 2) + pow(trees[i].x_y_cor[1] - p.x_y_cor[1], 2));
-                distances[i] = distance;
-            }
-
-            auto min_distance_iter = std::min_element(distances.begin(), distances.end());
+        for (int i : tree_distances.take_changed_patches()) {   // same index as the patch grid
+            patch& p = patches[i];
             // update patch variables accordingly
-            p.distance_to_tree = *min_distance_iter;            // store the minimum distance
+            p.distance_to_tree = tree_distances.distance(i);    // store the minimum distance
             // calculate light availability based on distance to trees
-            if(p.distance_to_tree < 6){                         // below 6*5m = 30m distance, light availability is scaled to distance
-                p.light_availability = 1 - (1 / p.distance_to_tree);
-            } else {                                            // full light availability if distance to trees is greater than 30m
-                p.light_availability = 1;
+            if (selected_light_model == light_model::nearest_tree) {
+                if(p.distance_to_tree < 6){                     // below 6*5m = 30m distance, light availability is scaled to distance
+                    p.light_availability = 1 - (1 / p.distance_to_tree);
+                } else {                                        // full light availability if distance to trees is greater than 30m
+                    p.light_availability = 1;
+                }
             }
             if(p.burnt & deadwood_removed){                     // if the patch is burnt and deadwood removed, set water availability to 0.5
                 p.water_availability = 0.5;
             }
 
         }
+        if (selected_light_model == light_model::canopy_shading) {
+            // 3 box passes of radius 2 reach 6 patches = 30 m, as far as the nearest tree rule
+            std::vector<float> shading = canopy_shading(trees, x_size, y_size, 2);
+            for (size_t i = 0; i < patches.size(); i++) {
+                patches[i].light_availability = 1 - std::min(shading[i], 1.0f);   // no light left below dense canopy
+            }
+        }
     }
+    pop_factors.invalidate();   // light and water changed, the mortality and growth factors follow in the next year
     scene->addPixmap(QPixmap::fromImage(image)); // update the map
 }
 
+/**
+ * @brief MainWindow::setup_dispersal
+ * Function to prepare the selected dispersal mode once the trees are final after the fire
+ * - the seed direction tables and dispersal kernels of both species are set up for all dispersal modes
+ * - trees neither move nor die afterwards, so the expected seed rain is the same every year
+ *   and is only built here if the cached seed rain mode or the expected values demography is selected
+ * - long-distance tails and the fat-tailed kernel widen the seed shadow of every tree to hundreds of patches,
+ *   then the field is built by FFT convolution instead of stamping every tree
+ */
+dispersal_stencil_set stencils;     // seed direction tables and dispersal kernel per species
+seed_rain_field seed_rain;          // expected annual seed rain per patch for the cached seed rain mode
+seed_count_raster seed_arrivals;    // seeds landed per patch in one year of the fused exact dispersal, reset every year
+mean_field_populations expected_populations;    // expected counts of the patches in the expected values demography mode
+void MainWindow::setup_dispersal() {
+    stencils.build(trees, birch_dispersal, oak_dispersal, map_reach(x_size, y_size));   // no tail beyond the map diagonal
+    const bool expected_values = selected_demography_mode == demography_mode::expected_values;
+    if (selected_dispersal_mode == dispersal_mode::cached_seed_rain || expected_values) {
+        if (stencils.max_distance() > stencils.local_max_distance()) {
+            seed_rain.build_by_convolution(trees, stencils, x_size, y_size);
+        } else {
+            seed_rain.build(trees, stencils, x_size, y_size);
+        }
+        ui->progress_output_textEdit->append("Expected seeds per year: birch " + QString::number(seed_rain.get_total_intensity(0)) + ", oak " + QString::number(seed_rain.get_total_intensity(1)));
+    }
+    if (expected_values) {
+        expected_populations.reset(patches);
+        expected_populations.set_seed_rain(seed_rain, patches);
+    }
+}
+
 /**
  * @brief MainWindow::perform_dispersal
- * Procedure that is conducted each time step
- * - loop over the trees and calculate the real seed production as a random value between 0 and 1 multiplied by the max seed production
- * - seeds are dispersed in a uniform random 360 degree direction
- * - dispersal distance is modelled as exponential function
- * - seeds are registered to the destination patch
+ * Procedure that is conducted each time step, depending on the dispersal mode selected in the ui
+ * - exact per seed:
+ *   - loop over the trees and calculate the real seed production as a random value between 0 and 1 multiplied by the max seed production
+ *   - seeds are dispersed in a uniform random 360 degree direction
+ *   - dispersal distance follows the kernel selected per species in the ui, the original exponential decay by default
+ *   - a share of long-distance seeds mixes a power-law tail into the kernel, all distances are then drawn
+ *     from an alias table in constant time per seed, see dispersal_stencil.cpp
+ *   - seeds are registered to the destination patch via the patch grid
+ *   - trees are split across the threads selected in the ui, each tree draws from its own stream of the yearly
+ *     dispersal seed, so the result does not depend on the number of threads, see disperse_seeds_parallel() in dispersal.cpp
+ *   - the yearly dispersal seed is drawn from the philox4x32 stream of the run seed and the year
+ * - cached seed rain:
+ *   - Poisson distributed number of seeds per patch with the expected seed rain built in setup_dispersal() as mean
+ * - FFT convolution:
+ *   - the expected seed rain is convolved from the current trees each year, the cost depends on the map size only,
+ *     then seeds are drawn as in the cached seed rain mode
+ * Seeds only go into the patches, the map is drawn from them by update_map() when requested.
  */
 void MainWindow::perform_dispersal() {
-    for (auto& t : trees) {
-        if(t.burnt == false){
-            int real_seed_production = t.max_seed_production * rand_float_01(gen);     // real seed production as random number * max seed production
-            for (int i = 1; i <= real_seed_production; i++) {
-                float direction = 2 * M_PI * i / real_seed_production;             // direction of seed dispersal
-
-                float distance_decay = std::pow(2, -3 * rand_float_01(gen));          // distance decay of seed dispersal
-
-                int offset_x = static_cast<int>(t.dispersal_factor * distance_decay * cos(direction));
-                int offset_y = static_cast<int>(t.dispersal_factor * distance_decay * sin(direction));
-
-                int new_x = t.x_y_cor[0] + offset_x;
-                int new_y = t.x_y_cor[1] + offset_y;
-
-                // check if seed landed in the map extent (no torus wrapping implemented)
-                if (new_x >= 0 && new_x < x_size && new_y >= 0 && new_y < y_size) {
-
-                    image.setPixel(new_x, new_y, color_seeds);
-
-                    for (auto& p : patches) { //loop over patches to find the patch where the seed landed
-                        if (p.x_y_cor[0] == new_x && p.x_y_cor[1] == new_y) {
-                            p.update_N_seeds(1, t.species);
-                        }
-                    }
-                }
-            }
-        }
+    if (selected_demography_mode == demography_mode::expected_values) {
+        return;                     // the expected seed rain is part of the yearly matrix step
+    }
+    switch (selected_dispersal_mode) {
+    case dispersal_mode::exact_per_seed:
+        disperse_seeds_parallel(trees, stencils, patches,
+                                philox4x32(run_seed, random_purpose::seed_dispersal, simulated_year, 0).next_64(), workers);
+        break;
+    case dispersal_mode::cached_seed_rain:
+        seed_rain.draw_seeds(patches, run_seed, simulated_year);
+        break;
+    case dispersal_mode::convolution_seed_rain:
+        seed_rain.build_by_convolution(trees, stencils, x_size, y_size);
+        seed_rain.draw_seeds(patches, run_seed, simulated_year);
+        break;
     }
-    scene->addPixmap(QPixmap::fromImage(image));
 }
 
 /**
@@ -417,71 +514,34 @@ void MainWindow::perform_dispersal() {
  *    first: advancement of height class 3 into 4 to not have saplings from height class 2
  *        advancing and dying at the same time
  *    next:  continue with height class 3 down to the seeds
+ * - the mortality and growth factors of the patches are computed once after the environment was set up,
+ *   see population_dynamics.cpp
+ * - the per-individual draws of the original model or binomial draws over whole cohorts, selected in the ui
+ * - or no draws at all: the expected counts of the cohort model advance with a transition matrix per patch,
+ *   see mean_field_populations.h, sweeps of many years can advance them k years in one step
+ * - patches are updated in tiles across the threads selected in the ui, every patch draws from its own stream,
+ *   so the result only depends on the run seed and never on the number of threads
 
  * possible extension:
  * - implement growth rate dependent on height class,
  *   i.e. higher growth rate for lower height classes but lower if the taller saplings create too much shade
  */
 void MainWindow::perform_pop_dynamics() {
-    for(unsigned int i = 0; i < patches.size(); i++){ // loop over all patches
-        for (int j = 0; j < 2; j++) {       // loop over both species => birch 0 and oak 1
-            float mortality_factor = patches[i].mortality_rate * (1 - patches[i].light_availability) * (1 - patches[i].water_availability); // combined mortality rate
-            float growth_factor =    patches[i].growth_rate *    patches[i].light_availability * patches[i].water_availability; // combined mortality rate
-
-            // first height class 4 mortality as no further growth is implemented
-            if(patches[i].N_height_class_4[j] > 0){   // only continue if there is at least 1 sapling in height class 4
-                for(int k = 0; k < patches[i].N_height_class_4[j]; k++){ // loop over all saplings in height class 4
-                    if(rand_float_01(gen) < mortality_factor){     // probability check for mortality
-                        patches[i].N_height_class_4[j] -= 1;             // if passed, sapling dies
-                    }
-                }
-            }
-            // same for height class 3 and so on
-            if(patches[i].N_height_class_3[j] > 0){   // only continue if there is at least 1 sapling in height class 3
-                for(int k = 0; k < patches[i].N_height_class_3[j]; k++){ // loop over all saplings in height class 3
-                    if(rand_float_01(gen) < mortality_factor){     // probability check for mortality
-                        patches[i].N_height_class_3[j] -= 1;             // if passed, sapling dies
-                    }
-                    if(rand_float_01(gen) < growth_factor){        // probability check for growth
-                        patches[i].N_height_class_4[j] += 1;             // if passed, sapling advances to height class 4
-                        patches[i].N_height_class_3[j] -= 1;             // and is removed from height class 3
-                    }
-                }
-            }
-            if(patches[i].N_height_class_2[j] > 0){
-                for(int k = 0; k < patches[i].N_height_class_2[j]; k++){
-                    if(rand_float_01(gen) < mortality_factor){
-                        patches[i].N_height_class_2[j] -= 1;
-                    }
-                    if(rand_float_01(gen) < growth_factor){
-                        patches[i].N_height_class_3[j] += 1;
-                        patches[i].N_height_class_2[j] -= 1;
-                    }
-                }
-            }
-            if(patches[i].N_height_class_1[j] > 0){
-                for(int k = 0; k < patches[i].N_height_class_1[j]; k++){
-                    if(rand_float_01(gen) < mortality_factor){
-                        patches[i].N_height_class_1[j] -= 1;
-                    }
-                    if(rand_float_01(gen) < patches[i].growth_rate){
-                        patches[i].N_height_class_2[j] += 1;
-                        patches[i].N_height_class_1[j] -= 1;
-                    }
-                }
-            }
-            if(patches[i].N_seeds[j] > 0){
-                for (int k = 0; k < patches[i].N_seeds[j]; k++) {
-                    if (rand_float_01(gen) < mortality_factor) {
-                        patches[i].N_seeds[j] -= 1;
-                    }
-                    if (rand_float_01(gen) < growth_factor) {
-                        patches[i].N_height_class_1[j] += 1;
-                        patches[i].N_seeds[j] -= 1;
-                    }
-                }
-            }
-        }
+    if (!pop_factors.is_valid()) {
+        pop_factors.update(patches);
+        expected_populations.set_transitions(pop_factors);
+    }
+    switch (selected_demography_mode) {
+    case demography_mode::per_individual:
+        advance_populations_parallel(patches, pop_factors, run_seed, simulated_year, workers);
+        break;
+    case demography_mode::binomial_cohorts:
+        advance_cohorts_parallel(patches, pop_factors, run_seed, simulated_year, workers);     // cost per patch independent of the population sizes
+        break;
+    case demography_mode::expected_values:
+        expected_populations.advance();                         // seed rain and one year of the matrix model
+        expected_populations.write_counts(patches);             // rounded for the map
+        break;
     }
 }
 
@@ -490,45 +550,76 @@ void MainWindow::perform_pop_dynamics() {
  * Procedure conducted each time step
  * count the population size of the different life stages from seed to height class 1-4 in the patches
  * population size counted separately for each species and for burnt patches
+ * only occupied patches are visited, see patch_grid::for_each_occupied()
+ * in the expected values mode the totals are summed from the expected counts before rounding
  */
 void MainWindow::count_populations() {
-    std::vector<int> birch_pop = {0, 0, 0, 0, 0};               // initializing vectors for population size to 0
-    std::vector<int> oak_pop = {0, 0, 0, 0, 0};
-    std::vector<int> birch_pop_burnt_area = {0, 0, 0, 0, 0};
-    std::vector<int> oak_pop_burnt_area = {0, 0, 0, 0, 0};
-
-    for (auto& p : patches) {                                   // loop over all patches
-        birch_pop[0] += p.N_seeds[0];
-        birch_pop[1] += p.N_height_class_1[0];
-        birch_pop[2] += p.N_height_class_2[0];
-        birch_pop[3] += p.N_height_class_3[0];
-        birch_pop[4] += p.N_height_class_4[0];
-
-        oak_pop[0] += p.N_seeds[1];
-        oak_pop[1] += p.N_height_class_1[1];
-        oak_pop[2] += p.N_height_class_2[1];
-        oak_pop[3] += p.N_height_class_3[1];
-        oak_pop[4] += p.N_height_class_4[1];
-
-        if(p.burnt == true){                                    // if patch is burnt, add population size to burnt area vector as well
-            birch_pop_burnt_area[0] += p.N_seeds[0];
-            birch_pop_burnt_area[1] += p.N_height_class_1[0];
-            birch_pop_burnt_area[2] += p.N_height_class_2[0];
-            birch_pop_burnt_area[3] += p.N_height_class_3[0];
-            birch_pop_burnt_area[4] += p.N_height_class_4[0];
-
-            oak_pop_burnt_area[0] += p.N_seeds[1];
-            oak_pop_burnt_area[1] += p.N_height_class_1[1];
-            oak_pop_burnt_area[2] += p.N_height_class_2[1];
-            oak_pop_burnt_area[3] += p.N_height_class_3[1];
-            oak_pop_burnt_area[4] += p.N_height_class_4[1];
+    population_totals totals;                                   // population size per species and stage, initialized to 0
+
+    if (selected_demography_mode == demography_mode::expected_values && expected_populations.size() == patches.size()) {
+        for (int s = 0; s < N_stages; s++) {                    // totals of the expected counts, not of the rounded patches
+            for (int j = 0; j < N_species; j++) {
+                totals.all[j][s] = std::lround(expected_populations.total(s, j));
+                totals.burnt[j][s] = std::lround(expected_populations.total_burnt(s, j, patches));
+            }
         }
+    } else {
+        totals = count_totals(patches);                         // loop over all patches holding seeds or saplings
     }
+    store_totals(totals);
+}
 
-    birch_pop_total.push_back(birch_pop);                       // store population size in vectors, push back to add current year of the loop
-    birch_pop_burnt_area_total.push_back(birch_pop_burnt_area);
-    oak_pop_total.push_back(oak_pop);
-    oak_pop_burnt_area_total.push_back(oak_pop_burnt_area);
+/**
+ * @brief MainWindow::submit_populations
+ * Procedure conducted each time step instead of count_populations() if pipelined counting is selected in the ui
+ * - the patches of the year are copied into the snapshot of population_analysis and counted there by its consumer thread,
+ *   while the next year is already simulated, see analysis_pipeline.h
+ * - the copy waits until the previous year is counted, so at most one year is counted behind the simulation
+ */
+void MainWindow::submit_populations() {
+    population_analysis.submit(patches, simulated_year);
+}
+
+/**
+ * @brief MainWindow::store_totals
+ * store population size in vectors, push back to add current year of the loop
+ */
+void MainWindow::store_totals(const population_totals& totals) {
+    for (int j = 0; j < N_species; j++) {
+        pop_total[j].push_back(totals.all[j]);
+        pop_burnt_area_total[j].push_back(totals.burnt[j]);
+    }
+}
+
+/**
+ * @brief MainWindow::perform_fused_year
+ * Procedure conducted each time step instead of perform_dispersal(), perform_pop_dynamics() and count_populations()
+ * if the fused year step is selected in the ui
+ * - exact per seed: the trees still scatter their seeds first, the landed seeds are then added patch by patch
+ * - seed rain modes: the Poisson draws of each patch are made right before its demography
+ * - each patch is visited once: seeds, demography and counting, see year_step.h
+ * - every draw comes from the same stream as in the separate procedures, so the run is the same with either setting
+ */
+void MainWindow::perform_fused_year() {
+    if (!pop_factors.is_valid()) {
+        pop_factors.update(patches);
+        expected_populations.set_transitions(pop_factors);
+    }
+    switch (selected_dispersal_mode) {
+    case dispersal_mode::exact_per_seed: {
+        seed_arrivals.reset(x_size, y_size);                        // keeps its arrays from the year before
+        scatter_seeds_tiled(trees, stencils, seed_arrivals,
+                            philox4x32(run_seed, random_purpose::seed_dispersal, simulated_year, 0).next_64(), workers);
+        store_totals(advance_year_fused(patches, seed_arrivals, pop_factors, selected_demography_mode, run_seed, simulated_year, workers));
+        return;
+    }
+    case dispersal_mode::cached_seed_rain:
+        break;
+    case dispersal_mode::convolution_seed_rain:
+        seed_rain.build_by_convolution(trees, stencils, x_size, y_size);
+        break;
+    }
+    store_totals(advance_year_fused(patches, seed_rain, pop_factors, selected_demography_mode, run_seed, simulated_year, workers));
 }
 
 /**
@@ -537,6 +628,8 @@ void MainWindow::count_populations() {
  * - N_seeds_saplings are scaled in green
  * - trees are displayed as 5 * 5 pixels for improved visibility
  * - trees are displayed in grey if burnt
+ * Render stage of the simulation, called after setup, at the end of a run and at the map update interval of the ui,
+ * the pixmap of the map is replaced instead of stacking a new one onto the scene for every frame.
  */
 void MainWindow::update_map(){
     std::vector<int> N_seeds_saplings(patches.size(), 0);               // vector to store total number of seeds and saplings per patch
@@ -545,10 +638,12 @@ void MainWindow::update_map(){
     }
     auto max_N_seeds_saplings_iter = std::max_element(N_seeds_saplings.begin(), N_seeds_saplings.end()); // find maximum number of seeds and saplings per patch
     int max_N_seeds_saplings = *max_N_seeds_saplings_iter;              // store maximum number of seeds and saplings per patch
-    for (auto& p : patches) {                                           // loop to set pixel color based on total number of seedlings and saplings per patch (max density is full green)
-        int patch_pop = p.get_all_N_seeds_saplings();                   // local patch population of all seeds and saplings
-        if (patch_pop > 0){
-            image.setPixelColor(p.x_y_cor[0], p.x_y_cor[1],  QColor(0, 255, 0, 255 * patch_pop / max_N_seeds_saplings));
+    for (int x = 0; x < patches.get_x_size(); x++) {                    // loop to set pixel color based on total number of seedlings and saplings per patch (max density is full green)
+        for (int y = 0; y < patches.get_y_size(); y++) {
+            int patch_pop = patches.at(x, y).get_all_N_seeds_saplings();    // local patch population of all seeds and saplings
+            if (patch_pop > 0){
+                image.setPixelColor(x, y, QColor(0, 255, 0, 255 * patch_pop / max_N_seeds_saplings));
+            }
         }
     }
     // trees mapped last to ensure they are visible
@@ -565,7 +660,11 @@ void MainWindow::update_map(){
             }
         }
     }
-    scene->addPixmap(QPixmap::fromImage(image));
+    if (map_item == nullptr) {
+        map_item = scene->addPixmap(QPixmap::fromImage(image));
+    } else {
+        map_item->setPixmap(QPixmap::fromImage(image));
+    }
 }
 
 /**
@@ -575,10 +674,10 @@ void MainWindow::update_map(){
 void MainWindow::clear_charts()
 {
     //clear all output vectors
-    birch_pop_total.clear();
-    birch_pop_burnt_area_total.clear();
-    oak_pop_total.clear();
-    oak_pop_burnt_area_total.clear();
+    for (int j = 0; j < N_species; j++) {
+        pop_total[j].clear();
+        pop_burnt_area_total[j].clear();
+    }
 
     // clear charts for setup
     N_birch_pop_chart->removeAllSeries();
@@ -591,178 +690,44 @@ void MainWindow::clear_charts()
  * @brief MainWindow::draw_charts
  *  Function to draw the four output charts in the ui
  *   - one series per species and life stage in all patches and in just the burnt area
- *   - 5 series per chart
+ *   - one series per stage in every chart, names and species from population_traits.h
  *   - values scaled to hectares for comparable output
  */
 void MainWindow::draw_charts(){
-    QLineSeries *N_birch_seeds_series = new QLineSeries();
-    N_birch_seeds_series->setColor(Qt::black); // default color: blue
-    N_birch_seeds_series->setName("Seeds");
-    QLineSeries *N_birch_hc1_series = new QLineSeries();
-    N_birch_hc1_series->setColor(Qt::black); // default color: blue
-    N_birch_hc1_series->setName("Height class 1");
-    QLineSeries *N_birch_hc2_series = new QLineSeries();
-    N_birch_hc2_series->setColor(Qt::black); // default color: blue
-    N_birch_hc2_series->setName("Height class 2");
-    QLineSeries *N_birch_hc3_series = new QLineSeries();
-    N_birch_hc3_series->setColor(Qt::black); // default color: blue
-    N_birch_hc3_series->setName("Height class 3");
-    QLineSeries *N_birch_hc4_series = new QLineSeries();
-    N_birch_hc4_series->setColor(Qt::black); // default color: blue
-    N_birch_hc4_series->setName("Height class 4");
-
-    QLineSeries *N_birch_burnt_area_seeds_series = new QLineSeries();
-    N_birch_burnt_area_seeds_series->setColor(Qt::black);
-    N_birch_burnt_area_seeds_series->setName("Seeds");
-    QLineSeries *N_birch_burnt_area_hc1_series = new QLineSeries();
-    N_birch_burnt_area_hc1_series->setColor(Qt::black);
-    N_birch_burnt_area_hc1_series->setName("Height class 1");
-    QLineSeries *N_birch_burnt_area_hc2_series = new QLineSeries();
-    N_birch_burnt_area_hc2_series->setColor(Qt::black);
-    N_birch_burnt_area_hc2_series->setName("Height class 2");
-    QLineSeries *N_birch_burnt_area_hc3_series = new QLineSeries();
-    N_birch_burnt_area_hc3_series->setColor(Qt::black);
-    N_birch_burnt_area_hc3_series->setName("Height class 3");
-    QLineSeries *N_birch_burnt_area_hc4_series = new QLineSeries();
-    N_birch_burnt_area_hc4_series->setColor(Qt::black);
-    N_birch_burnt_area_hc4_series->setName("Height class 4");
-
-    QLineSeries *N_oak_seeds_series = new QLineSeries();
-    N_oak_seeds_series->setColor(Qt::black);
-    N_oak_seeds_series->setName("Seeds");
-    QLineSeries *N_oak_hc1_series = new QLineSeries();
-    N_oak_hc1_series->setColor(Qt::black);
-    N_oak_hc1_series->setName("Height class 1");
-    QLineSeries *N_oak_hc2_series = new QLineSeries();
-    N_oak_hc2_series->setColor(Qt::black);
-    N_oak_hc2_series->setName("Height class 2");
-    QLineSeries *N_oak_hc3_series = new QLineSeries();
-    N_oak_hc3_series->setColor(Qt::black);
-    N_oak_hc3_series->setName("Height class 3");
-    QLineSeries *N_oak_hc4_series = new QLineSeries();
-    N_oak_hc4_series->setColor(Qt::black);
-    N_oak_hc4_series->setName("Height class 4");
-
-    QLineSeries *N_oak_burnt_area_seeds_series = new QLineSeries();
-    N_oak_burnt_area_seeds_series->setColor(Qt::black);
-    N_oak_burnt_area_seeds_series->setName("Seeds");
-    QLineSeries *N_oak_burnt_area_hc1_series = new QLineSeries();
-    N_oak_burnt_area_hc1_series->setColor(Qt::black);
-    N_oak_burnt_area_hc1_series->setName("Height class 1");
-    QLineSeries *N_oak_burnt_area_hc2_series = new QLineSeries();
-    N_oak_burnt_area_hc2_series->setColor(Qt::black);
-    N_oak_burnt_area_hc2_series->setName("Height class 2");
-    QLineSeries *N_oak_burnt_area_hc3_series = new QLineSeries();
-    N_oak_burnt_area_hc3_series->setColor(Qt::black);
-    N_oak_burnt_area_hc3_series->setName("Height class 3");
-    QLineSeries *N_oak_burnt_area_hc4_series = new QLineSeries();
-    N_oak_burnt_area_hc4_series->setColor(Qt::black);
-    N_oak_burnt_area_hc4_series->setName("Height class 4");
-
-    N_birch_seeds_series->clear();                      // clear all graph series
-    N_birch_hc1_series->clear();
-    N_birch_hc2_series->clear();
-    N_birch_hc3_series->clear();
-    N_birch_hc4_series->clear();
-
-    N_birch_burnt_area_seeds_series->clear();
-    N_birch_burnt_area_hc1_series->clear();
-    N_birch_burnt_area_hc2_series->clear();
-    N_birch_burnt_area_hc3_series->clear();
-    N_birch_burnt_area_hc4_series->clear();
-
-    N_oak_seeds_series->clear();
-    N_oak_hc1_series->clear();
-    N_oak_hc2_series->clear();
-    N_oak_hc3_series->clear();
-    N_oak_hc4_series->clear();
-
-    N_oak_burnt_area_seeds_series->clear();
-    N_oak_burnt_area_hc1_series->clear();
-    N_oak_burnt_area_hc2_series->clear();
-    N_oak_burnt_area_hc3_series->clear();
-    N_oak_burnt_area_hc4_series->clear();
-
-    // fill in the series with the data for each year
-    for (int time = 0; time < number_of_simulation_years; time++) {
-        N_birch_seeds_series->append(time, birch_pop_total[time][0] / pixel_to_ha_conv_factor);   // divide by conversion factor to get the number per ha as 300 m * 300 m = 90000 m^2 = 9 ha
-        N_birch_hc1_series->append(time, birch_pop_total[time][1] / pixel_to_ha_conv_factor);
-        N_birch_hc2_series->append(time, birch_pop_total[time][2] / pixel_to_ha_conv_factor);
-        N_birch_hc3_series->append(time, birch_pop_total[time][3] / pixel_to_ha_conv_factor);
-        N_birch_hc4_series->append(time, birch_pop_total[time][4] / pixel_to_ha_conv_factor);
-
-        N_birch_burnt_area_seeds_series->append(time, birch_pop_burnt_area_total[time][0] / pixel_to_ha_conv_factor);
-        N_birch_burnt_area_hc1_series->append(time, birch_pop_burnt_area_total[time][1] / pixel_to_ha_conv_factor);
-        N_birch_burnt_area_hc2_series->append(time, birch_pop_burnt_area_total[time][2] / pixel_to_ha_conv_factor);
-        N_birch_burnt_area_hc3_series->append(time, birch_pop_burnt_area_total[time][3] / pixel_to_ha_conv_factor);
-        N_birch_burnt_area_hc4_series->append(time, birch_pop_burnt_area_total[time][4] / pixel_to_ha_conv_factor);
-
-        N_oak_seeds_series->append(time, oak_pop_total[time][0] / pixel_to_ha_conv_factor);
-        N_oak_hc1_series->append(time, oak_pop_total[time][1] / pixel_to_ha_conv_factor);
-        N_oak_hc2_series->append(time, oak_pop_total[time][2] / pixel_to_ha_conv_factor);
-        N_oak_hc3_series->append(time, oak_pop_total[time][3] / pixel_to_ha_conv_factor);
-        N_oak_hc4_series->append(time, oak_pop_total[time][4] / pixel_to_ha_conv_factor);
-
-        N_oak_burnt_area_seeds_series->append(time, oak_pop_burnt_area_total[time][0] / pixel_to_ha_conv_factor);
-        N_oak_burnt_area_hc1_series->append(time, oak_pop_burnt_area_total[time][1] / pixel_to_ha_conv_factor);
-        N_oak_burnt_area_hc2_series->append(time, oak_pop_burnt_area_total[time][2] / pixel_to_ha_conv_factor);
-        N_oak_burnt_area_hc3_series->append(time, oak_pop_burnt_area_total[time][3] / pixel_to_ha_conv_factor);
-        N_oak_burnt_area_hc4_series->append(time, oak_pop_burnt_area_total[time][4] / pixel_to_ha_conv_factor);
-    }
+    QChart *pop_charts[N_species] = {N_birch_pop_chart, N_oak_pop_chart};   // charts of the ui in the order of model_species
+    QChart *burnt_area_charts[N_species] = {N_birch_burnt_area_chart, N_oak_burnt_area_chart};
+
+    for (int j = 0; j < N_species; j++) {
+        for (int s = 0; s < N_stages; s++) {
+            QLineSeries *pop_series = new QLineSeries();
+            pop_series->setColor(Qt::black);
+            pop_series->setName(stage_names[s]);
+            QLineSeries *burnt_area_series = new QLineSeries();
+            burnt_area_series->setColor(Qt::black);
+            burnt_area_series->setName(stage_names[s]);
+
+            // fill in the series with the data for each year
+            for (int time = 0; time < number_of_simulation_years; time++) {
+                pop_series->append(time, pop_total[j][time][s] / pixel_to_ha_conv_factor);   // divide by conversion factor to get the number per ha as 300 m * 300 m = 90000 m^2 = 9 ha
+                burnt_area_series->append(time, pop_burnt_area_total[j][time][s] / pixel_to_ha_conv_factor);
+            }
+            pop_charts[j]->addSeries(pop_series);
+            burnt_area_charts[j]->addSeries(burnt_area_series);
+        }
 
-    // Create legends for each chart
-    QLegend *birchPopLegend = N_birch_pop_chart->legend();
-    birchPopLegend->setAlignment(Qt::AlignRight);
-
-    QLegend *birchBurntAreaLegend = N_birch_burnt_area_chart->legend();
-    birchBurntAreaLegend->setAlignment(Qt::AlignRight);
-
-    QLegend *oakPopLegend = N_oak_pop_chart->legend();
-    oakPopLegend->setAlignment(Qt::AlignRight);
-
-    QLegend *oakBurntAreaLegend = N_oak_burnt_area_chart->legend();
-    oakBurntAreaLegend->setAlignment(Qt::AlignRight);
-
-    // add the series to the charts
-    N_birch_pop_chart->addSeries(N_birch_seeds_series);
-    N_birch_pop_chart->addSeries(N_birch_hc1_series);
-    N_birch_pop_chart->addSeries(N_birch_hc2_series);
-    N_birch_pop_chart->addSeries(N_birch_hc3_series);
-    N_birch_pop_chart->addSeries(N_birch_hc4_series);
-    N_birch_pop_chart->createDefaultAxes();
-    N_birch_pop_chart->setTitle("Birch seed and sapling population");
-    N_birch_pop_chart->axisX()->setTitleText("time [years]");
-    N_birch_pop_chart->axisY()->setTitleText("population density [N/ha]");
-
-    N_birch_burnt_area_chart->addSeries(N_birch_burnt_area_seeds_series);
-    N_birch_burnt_area_chart->addSeries(N_birch_burnt_area_hc1_series);
-    N_birch_burnt_area_chart->addSeries(N_birch_burnt_area_hc2_series);
-    N_birch_burnt_area_chart->addSeries(N_birch_burnt_area_hc3_series);
-    N_birch_burnt_area_chart->addSeries(N_birch_burnt_area_hc4_series);
-    N_birch_burnt_area_chart->createDefaultAxes();
-    N_birch_burnt_area_chart->setTitle("Birch seed and sapling population in burnt area");
-    N_birch_burnt_area_chart->axisX()->setTitleText("time [years]");
-    N_birch_burnt_area_chart->axisY()->setTitleText("population density [N/ha]");
-
-    N_oak_pop_chart->addSeries(N_oak_seeds_series);
-    N_oak_pop_chart->addSeries(N_oak_hc1_series);
-    N_oak_pop_chart->addSeries(N_oak_hc2_series);
-    N_oak_pop_chart->addSeries(N_oak_hc3_series);
-    N_oak_pop_chart->addSeries(N_oak_hc4_series);
-    N_oak_pop_chart->createDefaultAxes();
-    N_oak_pop_chart->setTitle("Oak seed and sapling population");
-    N_oak_pop_chart->axisX()->setTitleText("time [years]");
-    N_oak_pop_chart->axisY()->setTitleText("population density [N/ha]");
-
-    N_oak_burnt_area_chart->addSeries(N_oak_burnt_area_seeds_series);
-    N_oak_burnt_area_chart->addSeries(N_oak_burnt_area_hc1_series);
-    N_oak_burnt_area_chart->addSeries(N_oak_burnt_area_hc2_series);
-    N_oak_burnt_area_chart->addSeries(N_oak_burnt_area_hc3_series);
-    N_oak_burnt_area_chart->addSeries(N_oak_burnt_area_hc4_series);
-    N_oak_burnt_area_chart->createDefaultAxes();
-    N_oak_burnt_area_chart->setTitle("Oak seed and sapling population in burnt area");
-    N_oak_burnt_area_chart->axisX()->setTitleText("time [years]");
-    N_oak_burnt_area_chart->axisY()->setTitleText("population density [N/ha]");
+        // legends, axes and titles of both charts of the species
+        pop_charts[j]->legend()->setAlignment(Qt::AlignRight);
+        pop_charts[j]->createDefaultAxes();
+        pop_charts[j]->setTitle(QString(model_species[j].name) + " seed and sapling population");
+        pop_charts[j]->axisX()->setTitleText("time [years]");
+        pop_charts[j]->axisY()->setTitleText("population density [N/ha]");
+
+        burnt_area_charts[j]->legend()->setAlignment(Qt::AlignRight);
+        burnt_area_charts[j]->createDefaultAxes();
+        burnt_area_charts[j]->setTitle(QString(model_species[j].name) + " seed and sapling population in burnt area");
+        burnt_area_charts[j]->axisX()->setTitleText("time [years]");
+        burnt_area_charts[j]->axisY()->setTitleText("population density [N/ha]");
+    }
 }
 
 /**
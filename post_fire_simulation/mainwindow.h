@@ -3,8 +3,15 @@
 
 #include <QMainWindow>
 #include <QtCharts>
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <QImage>
+#include "dispersal.h"
+#include "canopy_shading.h"
+#include "analysis_pipeline.h"
+#include "population_dynamics.h"
+#include "year_step.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -19,14 +26,25 @@ public:
     ~MainWindow();
     int number_of_simulation_years = 0;
 
-    // Vectors to store the population counts as sum of all patches at each time step
-    std::vector<std::vector<int>> birch_pop_total;
-    std::vector<std::vector<int>> oak_pop_total;
-    std::vector<std::vector<int>> birch_pop_burnt_area_total;
-    std::vector<std::vector<int>> oak_pop_burnt_area_total;
+    // Vectors to store the population counts as sum of all patches at each time step, one per species in the order of model_species
+    typedef std::array<int, N_stages> stage_totals;
+    std::vector<stage_totals> pop_total[N_species];
+    std::vector<stage_totals> pop_burnt_area_total[N_species];
 
     int N_trees = 0;
     bool deadwood_removed = false;
+    dispersal_mode selected_dispersal_mode = dispersal_mode::exact_per_seed;   // dispersal engine chosen in the ui
+    int N_threads = 1;                          // number of worker threads for the parallel procedures
+    thread_pool workers;                        // threads of the yearly parallel procedures, started at setup, see parallel.h
+    dispersal_settings birch_dispersal;         // dispersal kernel and long-distance tail chosen in the ui, see dispersal_kernel.h
+    dispersal_settings oak_dispersal;
+    int render_interval = 0;                    // years between map updates during a run, 0 draws the map only at the end
+    light_model selected_light_model = light_model::nearest_tree;    // how light_availability is derived from the trees, see canopy_shading.h
+    demography_mode selected_demography_mode = demography_mode::per_individual;   // how mortality and growth are drawn, see population_dynamics.h
+    year_step_mode selected_year_step = year_step_mode::separate_passes;        // three passes over the patches per year or one fused pass, see year_step.h
+    bool pipelined_analysis = false;            // counting of each year overlaps the next year, see analysis_pipeline.h
+    std::uint64_t run_seed = 1;                 // key of all random streams of the run, chosen in the ui or drawn at setup
+    int simulated_year = 0;                     // years simulated since setup, part of the key of the yearly random streams
 
 
 private slots:
@@ -39,7 +57,10 @@ private slots:
     void perform_dispersal();
     void perform_pop_dynamics();
     void setup_min_distance_to_tree();
+    void setup_dispersal();
     void count_populations();
+    void submit_populations();
+    void perform_fused_year();
 
     void update_map();
     void clear_charts();
@@ -48,12 +69,15 @@ private slots:
     bool test_number_of_simulation_years();
 
 private:
+    void store_totals(const population_totals& totals);    // appends the totals of a year to the chart vectors
+
     Ui::MainWindow *ui;
+    analysis_pipeline population_analysis;    // counts the snapshot of a year on its own thread, see submit_populations()
     QGraphicsScene *scene;
     QImage image;  // Declare image as a member variable
+    QGraphicsPixmapItem *map_item = nullptr;   // map drawn by update_map(), reused for every frame
 
     //  colors used for mapping
-    QRgb color_seeds = qRgb(0, 128, 0); // green color
     QRgb color_burnt_area = qRgb(0, 0, 0); // black color
 
 
@@ -0,0 +1,262 @@
+/**
+ * MEAN FIELD POPULATIONS CLASS
+ */
+
+#include "mean_field_populations.h"
+#include <cmath>
+#include <vector>
+
+void mean_field_populations::reset(const patch_grid& patches) {
+    N_patches = patches.size();
+    counts.assign(N_stages * N_species * N_patches, 0.0f);
+    const population_store& populations = patches.get_populations();
+    for (int s = 0; s < N_stages; s++) {
+        for (int j = 0; j < N_species; j++) {
+            const int* N = populations.counts(s, j);
+            float* expected = counts.data() + (s * N_species + j) * N_patches;
+            for (size_t i = 0; i < N_patches; i++) {
+                expected[i] = N[i];
+            }
+        }
+    }
+    seeds_per_year.assign(N_species * N_patches, 0.0f);
+    patch_class.assign(N_patches, 0);                       // no transitions until set_transitions()
+    N_classes = 1;
+    stay.assign(N_stages, 1.0f);
+    advance_to_next.assign(N_stages - 1, 0.0f);
+    power_years = 0;
+}
+
+void mean_field_populations::set_seed_rain(const seed_rain_field& seed_rain, const patch_grid& patches) {
+    for (int j = 0; j < N_species; j++) {
+        for (int x = 0; x < patches.get_x_size(); x++) {
+            for (int y = 0; y < patches.get_y_size(); y++) {
+                seeds_per_year[j * N_patches + patches.index(x, y)] = seed_rain.get_intensity(x, y, j);
+            }
+        }
+    }
+}
+
+/**
+ * @brief mean_field_populations::set_transitions
+ * the probabilities of advance_cohorts(): mortality first, then growth of the survivors,
+ * height class 1 grows with the germination growth and height class 4 does not grow
+ */
+void mean_field_populations::set_transitions(const transition_factors& factors) {
+    patch_class = factors.environment_class;
+    N_classes = factors.N_classes();
+    stay.assign(N_stages * N_classes, 1.0f);
+    advance_to_next.assign((N_stages - 1) * N_classes, 0.0f);
+    for (size_t c = 0; c < N_classes; c++) {
+        const environment_class_factors& environment = factors.classes[c];
+        const float survival = 1.0f - environment.mortality_draws.probability;
+        for (int s = 0; s < N_stages; s++) {
+            const stage_growth growth_kind = growth_of_stage<N_stages>(s);
+            if (growth_kind == stage_growth::none) {
+                stay[s * N_classes + c] = survival;
+                continue;
+            }
+            const float growth = growth_kind == stage_growth::germination_growth ? environment.germination_growth_draws.probability
+                                                                                : environment.growth_draws.probability;
+            stay[s * N_classes + c] = survival * (1.0f - growth);
+            advance_to_next[s * N_classes + c] = survival * growth;
+        }
+    }
+    power_years = 0;
+}
+
+/**
+ * @brief mean_field_populations::advance
+ * N_years = 1 applies A (x + r) directly, longer steps use A^k and A + ... + A^k,
+ * which are computed once per environment class for a new k or new transitions and then reused
+ */
+void mean_field_populations::advance(int N_years) {
+    if (N_years <= 0) {
+        return;
+    }
+    if (N_years == 1) {
+        advance_one_year();
+        return;
+    }
+    if (power_years != N_years) {
+        update_powers(N_years);
+    }
+    for (int j = 0; j < N_species; j++) {
+        float* x[N_stages];
+        for (int s = 0; s < N_stages; s++) {
+            x[s] = counts.data() + (s * N_species + j) * N_patches;
+        }
+        const float* r = seeds_per_year.data() + j * N_patches;
+        for (size_t i = 0; i < N_patches; i++) {
+            const size_t c = patch_class[i];
+            float old_x[N_stages];
+            for (int s = 0; s < N_stages; s++) {
+                old_x[s] = x[s][i];
+            }
+            int entry = 0;
+            for (int row = 0; row < N_stages; row++) {      // lower triangle, row by row
+                float sum = seed_power[row * N_classes + c] * r[i];
+                for (int column = 0; column <= row; column++, entry++) {
+                    sum += power[entry * N_classes + c] * old_x[column];
+                }
+                x[row][i] = sum;
+            }
+        }
+    }
+}
+
+/**
+ * @brief mean_field_populations::advance_one_year
+ * one streaming pass per species over flat arrays, from height class 4 down to the seeds
+ * so every stage still reads the count of the stage below from the start of the year
+ */
+void mean_field_populations::advance_one_year() {
+    const float* d[N_stages];
+    const float* a[N_stages - 1];
+    for (int s = 0; s < N_stages; s++) {
+        d[s] = stay.data() + s * N_classes;
+    }
+    for (int s = 0; s < N_stages - 1; s++) {
+        a[s] = advance_to_next.data() + s * N_classes;
+    }
+    for (int j = 0; j < N_species; j++) {
+        float* x[N_stages];
+        for (int s = 0; s < N_stages; s++) {
+            x[s] = counts.data() + (s * N_species + j) * N_patches;
+        }
+        const float* r = seeds_per_year.data() + j * N_patches;
+        for (size_t i = 0; i < N_patches; i++) {
+            const size_t c = patch_class[i];
+            const float seeds = x[stage_seeds][i] + r[i];
+            for (int s = N_stages - 1; s > stage_height_class_1; s--) {    // constant trip count, unrolled
+                x[s][i] = d[s][c] * x[s][i] + a[s - 1][c] * x[s - 1][i];
+            }
+            x[stage_height_class_1][i] = d[stage_height_class_1][c] * x[stage_height_class_1][i] + a[stage_seeds][c] * seeds;
+            x[stage_seeds][i] = d[stage_seeds][c] * seeds;
+        }
+    }
+}
+
+/**
+ * @brief mean_field_populations::update_powers
+ * A^k and the first column of A + ... + A^k of every environment class by binary exponentiation in double precision:
+ * k years split into a years and b years give A^(a+b) = A^a A^b and S(a+b) = S(a) + A^a S(b)
+ */
+void mean_field_populations::update_powers(int N_years) {
+    const int N_entries = N_stages * (N_stages + 1) / 2;
+    power.assign(N_entries * N_classes, 0.0f);
+    seed_power.assign(N_stages * N_classes, 0.0f);
+    for (size_t c = 0; c < N_classes; c++) {
+        double A[N_stages][N_stages] = {};
+        for (int s = 0; s < N_stages; s++) {
+            A[s][s] = stay[s * N_classes + c];
+            if (s > 0) {
+                A[s][s - 1] = advance_to_next[(s - 1) * N_classes + c];
+            }
+        }
+        double result_power[N_stages][N_stages] = {};      // 0 years: identity and no seeds
+        double result_seeds[N_stages] = {};
+        for (int s = 0; s < N_stages; s++) {
+            result_power[s][s] = 1.0;
+        }
+        double base_power[N_stages][N_stages];              // 1 year: A and the first column of A
+        double base_seeds[N_stages];
+        for (int row = 0; row < N_stages; row++) {
+            for (int column = 0; column < N_stages; column++) {
+                base_power[row][column] = A[row][column];
+            }
+            base_seeds[row] = A[row][0];
+        }
+        // (P_a, S_a) followed by (P_b, S_b) into (P_a P_b, S_a + P_a S_b), lower triangular products
+        auto combine = [](double P_a[N_stages][N_stages], double S_a[N_stages],
+                          const double P_b[N_stages][N_stages], const double S_b[N_stages]) {
+            double P[N_stages][N_stages] = {};
+            double S[N_stages];
+            for (int row = 0; row < N_stages; row++) {
+                S[row] = S_a[row];
+                for (int k = 0; k <= row; k++) {
+                    S[row] += P_a[row][k] * S_b[k];
+                    for (int column = 0; column <= k; column++) {
+                        P[row][column] += P_a[row][k] * P_b[k][column];
+                    }
+                }
+            }
+            for (int row = 0; row < N_stages; row++) {
+                S_a[row] = S[row];
+                for (int column = 0; column < N_stages; column++) {
+                    P_a[row][column] = P[row][column];
+                }
+            }
+        };
+        for (int k = N_years; k > 0; k >>= 1) {
+            if (k & 1) {
+                combine(result_power, result_seeds, base_power, base_seeds);
+            }
+            if (k > 1) {
+                double P[N_stages][N_stages];
+                double S[N_stages];
+                for (int row = 0; row < N_stages; row++) {
+                    S[row] = base_seeds[row];
+                    for (int column = 0; column < N_stages; column++) {
+                        P[row][column] = base_power[row][column];
+                    }
+                }
+                combine(base_power, base_seeds, P, S);
+            }
+        }
+        int entry = 0;
+        for (int row = 0; row < N_stages; row++) {
+            seed_power[row * N_classes + c] = result_seeds[row];
+            for (int column = 0; column <= row; column++, entry++) {
+                power[entry * N_classes + c] = result_power[row][column];
+            }
+        }
+    }
+    power_years = N_years;
+}
+
+/**
+ * @brief mean_field_populations::write_counts
+ * the patches get the expected counts rounded to whole individuals, the totals of the charts come from total()
+ */
+void mean_field_populations::write_counts(patch_grid& patches) const {
+    population_store& populations = patches.get_populations();
+    for (int s = 0; s < N_stages; s++) {
+        for (int j = 0; j < N_species; j++) {
+            int* N = populations.counts(s, j);
+            const float* expected = counts.data() + (s * N_species + j) * N_patches;
+            for (size_t i = 0; i < N_patches; i++) {
+                N[i] = static_cast<int>(std::lround(expected[i]));
+            }
+        }
+    }
+    patches.update_occupancy();
+}
+
+float mean_field_populations::expected_count(int stage, int species, size_t i) const {
+    return counts[(stage * N_species + species) * N_patches + i];
+}
+
+double mean_field_populations::total(int stage, int species) const {
+    const float* expected = counts.data() + (stage * N_species + species) * N_patches;
+    double sum = 0;
+    for (size_t i = 0; i < N_patches; i++) {
+        sum += expected[i];
+    }
+    return sum;
+}
+
+double mean_field_populations::total_burnt(int stage, int species, const patch_grid& patches) const {
+    const float* expected = counts.data() + (stage * N_species + species) * N_patches;
+    double sum = 0;
+    for (size_t i = 0; i < N_patches; i++) {
+        if (patches[i].burnt) {
+            sum += expected[i];
+        }
+    }
+    return sum;
+}
+
+size_t mean_field_populations::size() const {
+    return N_patches;
+}
@@ -0,0 +1,50 @@
+#ifndef MEAN_FIELD_POPULATIONS_H
+#define MEAN_FIELD_POPULATIONS_H
+
+#include "patch_grid.h"
+#include "population_dynamics.h"
+#include "seed_rain_field.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The mean_field_populations class
+ * Expected seed and sapling counts of all patches under the binomial cohort model, without random draws.
+ * Every patch has an N_stages x N_stages transition matrix A built from its transition factors: a stage stays with
+ * (1 - mortality) * (1 - growth) and advances with (1 - mortality) * growth. The expected seed rain r arrives
+ * before the demography, so a year is x <- A (x + r). Trees do not change after setup, so r is the same
+ * every year and k years are one step x <- A^k x + (A + ... + A^k) r with powers cached per patch.
+ * Counts are stored as structure of arrays like the population_store. The matrices and their powers are
+ * kept per environment class of the transition factors, a patch only refers to its class.
+ */
+class mean_field_populations {
+public:
+    // Member functions
+    void reset(const patch_grid& patches);                      // expected counts start at the counts of the patches, no seed rain
+    void set_seed_rain(const seed_rain_field& seed_rain, const patch_grid& patches);   // expected seeds arriving each year
+    void set_transitions(const transition_factors& factors);    // transition matrices of the patches from their factors
+    void advance(int N_years = 1);                              // one year directly, several years from the cached matrix powers
+    void write_counts(patch_grid& patches) const;               // rounded expected counts into the patches for the map
+    float expected_count(int stage, int species, size_t i) const;
+    double total(int stage, int species) const;                 // expected count on the whole map
+    double total_burnt(int stage, int species, const patch_grid& patches) const;   // expected count on the burnt patches
+    size_t size() const;
+
+private:
+    void advance_one_year();
+    void update_powers(int N_years);
+
+    size_t N_patches = 0;
+    std::vector<float> counts;              // [stage][species][patch]
+    std::vector<float> seeds_per_year;      // [species][patch]
+    std::vector<std::uint32_t> patch_class; // environment class of every patch, see transition_factors
+    size_t N_classes = 0;
+    std::vector<float> stay;                // [stage][class], diagonal of A
+    std::vector<float> advance_to_next;     // [stage][class] for the first 4 stages, subdiagonal of A
+    int power_years = 0;                    // k of the cached powers, 0 if they are out of date
+    std::vector<float> power;               // [entry][class], lower triangle of A^k row by row
+    std::vector<float> seed_power;          // [stage][class], first column of A + ... + A^k
+};
+
+#endif // MEAN_FIELD_POPULATIONS_H
@@ -0,0 +1,87 @@
+/**
+ * THREAD POOL CLASS
+ */
+
+#include "parallel.h"
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+thread_pool::thread_pool(int N_threads) {
+    resize(N_threads);
+}
+
+thread_pool::~thread_pool() {
+    stop();
+}
+
+void thread_pool::resize(int N_threads) {
+    stop();
+    stopping = false;
+    for (int thread = 1; thread < std::max(N_threads, 1); thread++) {
+        workers.emplace_back(&thread_pool::work, this, thread, task_generation);
+    }
+}
+
+int thread_pool::size() const {
+    return static_cast<int>(workers.size()) + 1;
+}
+
+/**
+ * @brief thread_pool::run_task
+ * wakes the workers, runs thread 0 on the calling thread and waits until every worker finished the task
+ */
+void thread_pool::run_task(const std::function<void(int)>& function) {
+    if (workers.empty()) {
+        function(0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &function;
+        N_running = static_cast<int>(workers.size());
+        task_generation++;
+    }
+    task_ready.notify_all();
+    function(0);
+    std::unique_lock<std::mutex> lock(mutex);
+    task_done.wait(lock, [&] { return N_running == 0; });
+    task = nullptr;
+}
+
+/**
+ * @brief thread_pool::work
+ * loop of a worker thread, runs every task generation after the one it was started in
+ */
+void thread_pool::work(int thread, size_t generation) {
+    while (true) {
+        const std::function<void(int)>* current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_ready.wait(lock, [&] { return stopping || task_generation != generation; });
+            if (stopping) {
+                return;
+            }
+            generation = task_generation;
+            current = task;
+        }
+        (*current)(thread);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--N_running == 0) {
+            task_done.notify_one();
+        }
+    }
+}
+
+void thread_pool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
@@ -0,0 +1,66 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief run_parallel
+ * calls function(thread) for thread = 0 .. N_threads - 1, each on its own thread, and waits for all of them.
+ * Thread 0 runs on the calling thread, so N_threads = 1 does not start any thread.
+ */
+template <typename Function>
+void run_parallel(int N_threads, Function function) {
+    std::vector<std::thread> workers;
+    for (int thread = 1; thread < N_threads; thread++) {
+        workers.emplace_back(function, thread);
+    }
+    function(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief The thread_pool class
+ * Same calls as run_parallel(), but the threads are started once and wait for the next call,
+ * so procedures running every year do not pay for starting and joining their threads.
+ * Thread 0 is the calling thread, a pool of size 1 has no worker threads.
+ */
+class thread_pool {
+public:
+    explicit thread_pool(int N_threads = 1);
+    ~thread_pool();
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    void resize(int N_threads);                 // stops the workers and starts N_threads - 1 new ones
+    int size() const;                           // number of threads including the calling thread
+
+    template <typename Function>
+    void run(Function function);                // calls function(thread) for thread = 0 .. size() - 1 and waits for all of them
+
+private:
+    void run_task(const std::function<void(int)>& function);
+    void work(int thread, size_t generation);
+    void stop();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable task_ready;
+    std::condition_variable task_done;
+    const std::function<void(int)>* task = nullptr;
+    size_t task_generation = 0;                 // counts the calls, a worker runs each generation once
+    int N_running = 0;                          // workers still running the current task
+    bool stopping = false;
+};
+
+template <typename Function>
+void thread_pool::run(Function function) {
+    run_task(std::function<void(int)>(std::ref(function)));
+}
+
+#endif // PARALLEL_H
@@ -3,16 +3,113 @@
  */
 
 #include "patch.h"
+#include <cmath>
+#include <memory>
+#include <utility>
 #include <vector>
 #include <string>
 #include <random>
 
-patch::patch() {}
+/**
+ * @brief stage_counts::stage_counts
+ * @param birch, oak the two counts viewed, in a population_store or in the own counts of a patch
+ */
+stage_counts::stage_counts(int* birch, int* oak) : birch(birch), oak(oak) {}
+
+stage_counts& stage_counts::operator=(const stage_counts& other) {
+    *birch = *other.birch;
+    *oak = *other.oak;
+    return *this;
+}
+
+stage_counts& stage_counts::operator=(std::initializer_list<int> counts) {
+    *birch = counts.size() > 0 ? *counts.begin() : 0;
+    *oak = counts.size() > 1 ? *(counts.begin() + 1) : 0;
+    return *this;
+}
+
+bool stage_counts::operator==(const stage_counts& other) const {
+    return *birch == *other.birch && *oak == *other.oak;
+}
+
+bool stage_counts::operator!=(const stage_counts& other) const {
+    return !(*this == other);
+}
+
+patch::patch() : patch(std::unique_ptr<int[]>(new int[N_stages * N_species]())) {}
+
+patch::patch(std::unique_ptr<int[]> counts)
+    : N_seeds(&counts[2 * stage_seeds], &counts[2 * stage_seeds + 1]),
+      N_height_class_1(&counts[2 * stage_height_class_1], &counts[2 * stage_height_class_1 + 1]),
+      N_height_class_2(&counts[2 * stage_height_class_2], &counts[2 * stage_height_class_2 + 1]),
+      N_height_class_3(&counts[2 * stage_height_class_3], &counts[2 * stage_height_class_3 + 1]),
+      N_height_class_4(&counts[2 * stage_height_class_4], &counts[2 * stage_height_class_4 + 1]),
+      own_counts(std::move(counts)) {}
 
 patch::patch(std::string patch_id,
              std::vector<int> x_y_cor,
              std::vector<int> N_seeds)
-    : patch_id(patch_id), x_y_cor(x_y_cor), N_seeds(N_seeds) {}
+    : patch() {
+    (void)patch_id;                                 // the id is derived from the coordinates, see get_patch_id()
+    for (size_t i = 0; i < x_y_cor.size() && i < 2; i++) {
+        this->x_y_cor[i] = x_y_cor[i];
+    }
+    for (size_t i = 0; i < N_seeds.size() && i < 2; i++) {
+        this->N_seeds[i] = N_seeds[i];
+    }
+}
+
+patch::patch(int x, int y, population_store& populations, size_t i)
+    : x_y_cor{x, y},
+      N_seeds(populations.counts(stage_seeds, 0) + i, populations.counts(stage_seeds, 1) + i),
+      N_height_class_1(populations.counts(stage_height_class_1, 0) + i, populations.counts(stage_height_class_1, 1) + i),
+      N_height_class_2(populations.counts(stage_height_class_2, 0) + i, populations.counts(stage_height_class_2, 1) + i),
+      N_height_class_3(populations.counts(stage_height_class_3, 0) + i, populations.counts(stage_height_class_3, 1) + i),
+      N_height_class_4(populations.counts(stage_height_class_4, 0) + i, populations.counts(stage_height_class_4, 1) + i) {}
+
+/**
+ * @brief patch::patch
+ * copies are independent patches with their own counts, also when copied from a patch of a grid
+ */
+patch::patch(const patch& other) : patch() {
+    *this = other;
+}
+
+patch::patch(patch&& other) noexcept
+    : x_y_cor(other.x_y_cor),
+      N_seeds(other.N_seeds), N_height_class_1(other.N_height_class_1), N_height_class_2(other.N_height_class_2),
+      N_height_class_3(other.N_height_class_3), N_height_class_4(other.N_height_class_4),
+      mortality_rate(other.mortality_rate), growth_rate(other.growth_rate), burnt(other.burnt),
+      distance_to_tree(other.distance_to_tree), light_availability(other.light_availability),
+      water_availability(other.water_availability), own_counts(std::move(other.own_counts)) {}
+
+/**
+ * @brief patch::operator=
+ * writes the counts of the other patch into the counts viewed by this one, e.g. into the store of its grid
+ */
+patch& patch::operator=(const patch& other) {
+    N_seeds = other.N_seeds;
+    N_height_class_1 = other.N_height_class_1;
+    N_height_class_2 = other.N_height_class_2;
+    N_height_class_3 = other.N_height_class_3;
+    N_height_class_4 = other.N_height_class_4;
+    copy_environment(other);
+    return *this;
+}
+
+void patch::copy_environment(const patch& other) {
+    x_y_cor = other.x_y_cor;
+    mortality_rate = other.mortality_rate;
+    growth_rate = other.growth_rate;
+    burnt = other.burnt;
+    distance_to_tree = other.distance_to_tree;
+    light_availability = other.light_availability;
+    water_availability = other.water_availability;
+}
+
+std::string patch::get_patch_id() const {
+    return std::to_string(x_y_cor[0]) + "_" + std::to_string(x_y_cor[1]);
+}
 
 /**
  * @brief patch::update_N_seeds
@@ -21,10 +118,9 @@ patch::patch(std::string patch_id,
  * @param species
  */
 void patch::update_N_seeds(int count, char species) {
-    if (species == 'b') {
-        N_seeds[0] += count;
-    } else if (species == 'o') {
-        N_seeds[1] += count;
+    const int s = species_index(species);
+    if (s >= 0) {
+        N_seeds[s] += count;
     }
 }
 
@@ -64,3 +160,17 @@ int patch::get_all_N_seeds_saplings(){
     }
     return N_seeds_saplings;
 }
+
+/**
+ * @brief patch::is_empty
+ * @return true if all counts are 0, patches with negative counts are not empty
+ */
+bool patch::is_empty() const {
+    for (int i = 0; i < 2; ++i) {
+        if (N_seeds[i] != 0 || N_height_class_1[i] != 0 || N_height_class_2[i] != 0 ||
+            N_height_class_3[i] != 0 || N_height_class_4[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
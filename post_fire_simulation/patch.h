@@ -1,39 +1,80 @@
 #ifndef PATCH_H
 #define PATCH_H
 
+#include "population_store.h"
+#include <array>
+#include <initializer_list>
+#include <memory>
 #include <vector>
 #include <string>
 #include <random>
 
+/**
+ * @brief The stage_counts class
+ * View of the birch and oak count of one stage of one patch, used like the former vector of two counts:
+ * [0] is birch and [1] is oak, assigning and comparing works on the counts themselves
+ */
+class stage_counts {
+public:
+    stage_counts(int* birch, int* oak);
+    stage_counts(const stage_counts& other) = default;     // the copy views the same counts
+
+    int& operator[](int species);
+    int operator[](int species) const;
+    stage_counts& operator=(const stage_counts& other);    // copies the counts, not the view
+    stage_counts& operator=(std::initializer_list<int> counts);
+    bool operator==(const stage_counts& other) const;
+    bool operator!=(const stage_counts& other) const;
+
+private:
+    int* birch;
+    int* oak;
+};
+
+inline int& stage_counts::operator[](int species) {
+    return species == 0 ? *birch : *oak;
+}
+
+inline int stage_counts::operator[](int species) const {
+    return species == 0 ? *birch : *oak;
+}
+
 /**
  * @brief The patch class
  * Every pixel representing 5 m * 5 m in the map is a patch of this class
  * containing information about the number of seeds and saplings of birch and oak
+ * - the patches of a patch_grid are views of the population_store of the grid, their counts live in its arrays
+ * - a patch created on its own or copied from another patch owns its counts, like the former patch with its own vectors
  */
 class patch {
 public:
     // Constructors
     patch();
-    patch(std::string patch_id,                     // patch id formatted as "x_y"
+    patch(std::string patch_id,                     // patch id formatted as "x_y", derived from the coordinates
           std::vector<int> x_y_cor,                 // x and y coordinates of the patch, also used to register the seed landing location
           std::vector<int> N_seeds);                // number of seeds
+    patch(int x, int y, population_store& populations, size_t i);     // patch of a grid, view of the counts of patch i in the store
+    patch(const patch& other);                      // the copy owns its counts
+    patch(patch&& other) noexcept;                  // keeps viewing the same counts
+    patch& operator=(const patch& other);           // copies counts and environment into this patch
 
     // Member functions
     void update_N_seeds(int count, char species);   // function to add and subtract seeds to this patch
     int get_all_N_seeds_saplings();                 // returns the total number of seeds and saplings per patch for mapping
+    bool is_empty() const;                          // true if the patch holds no seeds or saplings of either species
+    std::string get_patch_id() const;               // "x_y"
     float set_distance_to_tree(int x, int y);       // sets the distance to the nearest tree, described in patch.cpp
     void set_burnt();                               // sets the patch as burnt (boolean) if forest fire is simulated
 
     // Member variables
-    std::string patch_id;
-    std::vector<int> x_y_cor;
+    std::array<int, 2> x_y_cor = {0, 0};
 
-    // number of seeds and saplings per patch, single vectors for each class for simple readability, could be 2*5 vector as well
-    std::vector<int> N_seeds = {0, 0};              // first element is birch, second is oak
-    std::vector<int> N_height_class_1 = {0, 0};
-    std::vector<int> N_height_class_2 = {0, 0};
-    std::vector<int> N_height_class_3 = {0, 0};
-    std::vector<int> N_height_class_4 = {0, 0};
+    // number of seeds and saplings per patch, one view per class for simple readability, first element is birch, second is oak
+    stage_counts N_seeds;
+    stage_counts N_height_class_1;
+    stage_counts N_height_class_2;
+    stage_counts N_height_class_3;
+    stage_counts N_height_class_4;
 
     // distance independent, i.e. distance to trees is not considered
     float mortality_rate = 0.2;        // chance of the seed/sapling dying at a timestep. constant for all patches, modified into mortality factor according to light and water availability
@@ -45,9 +86,10 @@ public:
     float light_availability = 0.0f;   // higher at further distance to trees
     float water_availability = 1.0f;   // default max = 1, low when deadwood is removed
 
-    // no private variables for now as it was easier to not use any for now
 private:
-
+    explicit patch(std::unique_ptr<int[]> counts);  // patch owning the given zeroed counts
+    void copy_environment(const patch& other);
+    std::unique_ptr<int[]> own_counts;  // counts of a patch outside of a grid, [stage][species], nullptr for patches of a grid
 };
 
 #endif // PATCH_H
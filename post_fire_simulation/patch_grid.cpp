@@ -0,0 +1,184 @@
+/**
+ * PATCH GRID CLASS
+ */
+
+#include "patch_grid.h"
+#include <algorithm>
+#include <vector>
+#include <string>
+
+patch_grid::patch_grid() {}
+
+patch_grid::patch_grid(int x_size, int y_size) {
+    reset(x_size, y_size);
+}
+
+patch_grid::patch_grid(const patch_grid& other) {
+    *this = other;
+}
+
+/**
+ * @brief patch_grid::operator=
+ * copies the store and the patch environments, the patches are views of the own store and never of the other grid
+ */
+patch_grid& patch_grid::operator=(const patch_grid& other) {
+    if (this == &other) {
+        return *this;
+    }
+    reset(other.x_size, other.y_size);
+    for (size_t i = 0; i < patches.size(); i++) {
+        patches[i] = other.patches[i];
+    }
+    occupancy = other.occupancy;
+    return *this;
+}
+
+/**
+ * @brief patch_grid::reset
+ * clears the grid and creates one patch per pixel, x as outer and y as inner loop,
+ * which is the same order the patches were created in before and fixes index = x * y_size + y
+ * - the patches view the counts of the store at their index, all counts start at 0
+ * @param x_size number of horizontal patches
+ * @param y_size number of vertical patches
+ */
+void patch_grid::reset(int x_size, int y_size) {
+    this->x_size = x_size;
+    this->y_size = y_size;
+    patches.clear();
+    populations.reset(static_cast<size_t>(x_size) * y_size);
+    patches.reserve(static_cast<size_t>(x_size) * y_size);
+
+    for (int i = 0; i < x_size; i++) {
+        for (int j = 0; j < y_size; j++) {
+            patches.emplace_back(i, j, populations, patches.size());
+        }
+    }
+    occupancy.assign((patches.size() + 63) / 64, 0);
+}
+
+/**
+ * @brief patch_grid::copy_state
+ * copies the seed and sapling counts and the occupancy bitmap into the arrays this grid already has,
+ * so the patches keep viewing them and nothing is allocated, e.g. for a snapshot taken every year
+ * - the environment of the patches (burnt, light, water) is not copied, it does not change between the years of one setup,
+ *   a grid set up again needs a full copy
+ */
+void patch_grid::copy_state(const patch_grid& other) {
+    const size_t N_counts = N_stages * N_species * patches.size();
+    const int* counts = other.populations.counts(0, 0);
+    std::copy(counts, counts + N_counts, populations.counts(0, 0));
+    std::copy(other.occupancy.begin(), other.occupancy.end(), occupancy.begin());
+}
+
+/**
+ * @brief patch_grid::contains
+ * @return true if (x, y) lies inside the map extent (no torus wrapping implemented)
+ */
+bool patch_grid::contains(int x, int y) const {
+    return x >= 0 && x < x_size && y >= 0 && y < y_size;
+}
+
+/**
+ * @brief patch_grid::index
+ * @return position of the patch (x, y) in the patch vector, coordinates are not checked
+ */
+int patch_grid::index(int x, int y) const {
+    return x * y_size + y;
+}
+
+/**
+ * @brief patch_grid::at
+ * constant time lookup of the patch at the given coordinates, check with contains() first
+ */
+patch& patch_grid::at(int x, int y) {
+    return patches[index(x, y)];
+}
+
+const patch& patch_grid::at(int x, int y) const {
+    return patches[index(x, y)];
+}
+
+int patch_grid::get_x_size() const {
+    return x_size;
+}
+
+int patch_grid::get_y_size() const {
+    return y_size;
+}
+
+size_t patch_grid::size() const {
+    return patches.size();
+}
+
+patch& patch_grid::operator[](size_t i) {
+    return patches[i];
+}
+
+const patch& patch_grid::operator[](size_t i) const {
+    return patches[i];
+}
+
+std::vector<patch>::iterator patch_grid::begin() {
+    return patches.begin();
+}
+
+std::vector<patch>::iterator patch_grid::end() {
+    return patches.end();
+}
+
+std::vector<patch>::const_iterator patch_grid::begin() const {
+    return patches.begin();
+}
+
+std::vector<patch>::const_iterator patch_grid::end() const {
+    return patches.end();
+}
+
+population_store& patch_grid::get_populations() {
+    return populations;
+}
+
+const population_store& patch_grid::get_populations() const {
+    return populations;
+}
+
+void patch_grid::mark_occupied(size_t i) {
+    occupancy[i / 64] |= std::uint64_t(1) << (i % 64);
+}
+
+void patch_grid::mark_empty(size_t i) {
+    occupancy[i / 64] &= ~(std::uint64_t(1) << (i % 64));
+}
+
+bool patch_grid::is_occupied(size_t i) const {
+    return (occupancy[i / 64] >> (i % 64)) & 1;
+}
+
+/**
+ * @brief patch_grid::update_occupancy
+ * full pass over the patches, only needed where counts are written without mark_occupied()
+ */
+void patch_grid::update_occupancy() {
+    for (size_t i = 0; i < patches.size(); i++) {
+        if (populations.is_empty(i)) {
+            mark_empty(i);
+        } else {
+            mark_occupied(i);
+        }
+    }
+}
+
+size_t patch_grid::N_blocks() const {
+    return occupancy.size();
+}
+
+size_t patch_grid::N_occupied() const {
+    size_t N = 0;
+    for (std::uint64_t bits : occupancy) {
+        while (bits != 0) {
+            bits &= bits - 1;
+            N++;
+        }
+    }
+    return N;
+}
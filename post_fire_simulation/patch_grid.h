@@ -0,0 +1,114 @@
+#ifndef PATCH_GRID_H
+#define PATCH_GRID_H
+
+#include "patch.h"
+#include <cstdint>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * @brief The patch_grid class
+ * Container owning all patches of the map in a fixed column-major order (x outer, y inner),
+ * so the patch at (x, y) is found directly by its index instead of searching the whole map
+ * The seed and sapling counts of the patches are kept in a population_store in the same order.
+ */
+class patch_grid {
+public:
+    // Constructors
+    patch_grid();
+    patch_grid(int x_size, int y_size);             // creates x_size * y_size empty patches
+    patch_grid(const patch_grid& other);            // the patches of the copy view the copied store
+    patch_grid(patch_grid&& other) = default;
+    patch_grid& operator=(const patch_grid& other);
+    patch_grid& operator=(patch_grid&& other) = default;
+
+    // Member functions
+    void reset(int x_size, int y_size);             // drops all patches and creates a new empty map of the given extent
+    void copy_state(const patch_grid& other);       // copies counts and occupancy of a grid of the same extent, keeps the environment
+    bool contains(int x, int y) const;              // true if the coordinates are inside the map extent
+    int index(int x, int y) const;                  // position of the patch (x, y) in the underlying vector
+    patch& at(int x, int y);                        // direct access to the patch at the given coordinates
+    const patch& at(int x, int y) const;
+
+    int get_x_size() const;
+    int get_y_size() const;
+    size_t size() const;
+
+    // access by index and range-based for loops over all patches
+    patch& operator[](size_t i);
+    const patch& operator[](size_t i) const;
+    std::vector<patch>::iterator begin();
+    std::vector<patch>::iterator end();
+    std::vector<patch>::const_iterator begin() const;
+    std::vector<patch>::const_iterator end() const;
+
+    // seed and sapling counts of all patches as contiguous arrays, the patches are views of it
+    population_store& get_populations();
+    const population_store& get_populations() const;
+
+    // occupancy bitmap, so the yearly procedures only visit patches that may hold seeds or saplings
+    void mark_occupied(size_t i);                   // to be called whenever seeds are added to patch i
+    void mark_empty(size_t i);                      // to be called when the last seed or sapling of patch i is gone
+    bool is_occupied(size_t i) const;
+    void update_occupancy();                        // recomputes the bitmap from the counts, after writing counts directly
+    size_t N_occupied() const;
+    template <typename Function>
+    void for_each_occupied(Function function) const;    // calls function(i) for every occupied patch in index order
+    size_t N_blocks() const;                        // number of blocks of 64 patches in index order, one word of the bitmap each
+    template <typename Function>
+    void for_each_occupied(size_t first_block, size_t end_block, Function function) const;   // same within blocks first_block .. end_block - 1
+    template <typename Bits, typename Function>
+    void for_each_occupied_or(size_t first_block, size_t end_block, Bits extra_bits, Function function) const;   // also visits the patches set in extra_bits(block)
+
+private:
+    int x_size = 0;
+    int y_size = 0;
+    population_store populations;
+    std::vector<patch> patches;
+    std::vector<std::uint64_t> occupancy;           // bit i % 64 of word i / 64 is set if patch i is occupied
+};
+
+/**
+ * @brief patch_grid::for_each_occupied
+ * visits the set bits word by word, empty stretches of the map cost one test per 64 patches
+ */
+template <typename Function>
+void patch_grid::for_each_occupied(Function function) const {
+    for_each_occupied(0, occupancy.size(), function);
+}
+
+/**
+ * @brief patch_grid::for_each_occupied
+ * patches of different blocks never share a word of the bitmap, so threads working on separate blocks
+ * may call mark_empty() and mark_occupied() for their own patches
+ */
+template <typename Function>
+void patch_grid::for_each_occupied(size_t first_block, size_t end_block, Function function) const {
+    for_each_occupied_or(first_block, end_block, [](size_t) { return std::uint64_t(0); }, function);
+}
+
+/**
+ * @brief patch_grid::for_each_occupied_or
+ * same visits, but the bits of a block are combined with extra_bits(block) before the block is visited,
+ * e.g. with the patches receiving seeds this year, which are not occupied yet
+ */
+template <typename Bits, typename Function>
+void patch_grid::for_each_occupied_or(size_t first_block, size_t end_block, Bits extra_bits, Function function) const {
+    for (size_t word = first_block; word < end_block; word++) {
+        std::uint64_t bits = occupancy[word] | extra_bits(word);
+        while (bits != 0) {
+#ifdef _MSC_VER
+            unsigned long bit;
+            _BitScanForward64(&bit, bits);
+#else
+            const int bit = __builtin_ctzll(bits);
+#endif
+            function(word * 64 + bit);
+            bits &= bits - 1;                       // clear the lowest set bit
+        }
+    }
+}
+
+#endif // PATCH_GRID_H
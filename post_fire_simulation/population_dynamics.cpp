@@ -0,0 +1,229 @@
+/**
+ * POPULATION DYNAMICS
+ */
+
+#include "population_dynamics.h"
+#include "population_kernels.h"
+#include "sim_random.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include <random>
+
+/**
+ * @brief transition_factors::update
+ * same float expressions as the factors formerly computed for every patch, species and year,
+ * so the yearly draws compare against identical values
+ * - patches with bitwise identical factors share a class, neighbouring patches are compared first
+ *   as long runs of the map have the same environment
+ */
+void transition_factors::update(const patch_grid& patches) {
+    struct factor_key {
+        float mortality, growth, germination_growth;
+        bool operator==(const factor_key& other) const {
+            return std::memcmp(this, &other, sizeof(factor_key)) == 0;
+        }
+    };
+    struct factor_key_hash {
+        size_t operator()(const factor_key& key) const {
+            std::uint32_t bits[3];
+            std::memcpy(bits, &key, sizeof(bits));
+            return splitmix64::mix((std::uint64_t(bits[0]) << 32 | bits[1]) ^ (std::uint64_t(bits[2]) * 0x9e3779b97f4a7c15ULL));
+        }
+    };
+    std::unordered_map<factor_key, std::uint32_t, factor_key_hash> class_of_factors;
+    classes.clear();
+    environment_class.resize(patches.size());
+    factor_key previous_key = {0.0f, 0.0f, 0.0f};
+    std::uint32_t previous_class = 0;
+    for (size_t i = 0; i < patches.size(); i++) {
+        const patch& p = patches[i];
+        factor_key key;
+        key.mortality = p.mortality_rate * (1 - p.light_availability) * (1 - p.water_availability); // combined mortality rate
+        key.growth =    p.growth_rate *    p.light_availability * p.water_availability;             // combined growth rate
+        key.germination_growth = p.growth_rate;
+        if (i > 0 && key == previous_key) {
+            environment_class[i] = previous_class;
+            continue;
+        }
+        auto found = class_of_factors.emplace(key, static_cast<std::uint32_t>(classes.size()));
+        if (found.second) {
+            environment_class_factors factors;
+            factors.mortality = key.mortality;
+            factors.growth = key.growth;
+            factors.germination_growth = key.germination_growth;
+            factors.mortality_draws.build(key.mortality);
+            factors.growth_draws.build(key.growth);
+            factors.germination_growth_draws.build(key.germination_growth);
+            classes.push_back(std::move(factors));
+        }
+        environment_class[i] = found.first->second;
+        previous_key = key;
+        previous_class = found.first->second;
+    }
+    valid = true;
+}
+
+float transition_factors::mortality(size_t i) const {
+    return of_patch(i).mortality;
+}
+
+float transition_factors::growth(size_t i) const {
+    return of_patch(i).growth;
+}
+
+float transition_factors::germination_growth(size_t i) const {
+    return of_patch(i).germination_growth;
+}
+
+size_t transition_factors::N_classes() const {
+    return classes.size();
+}
+
+void transition_factors::invalidate() {
+    valid = false;
+}
+
+bool transition_factors::is_valid() const {
+    return valid;
+}
+
+/**
+ * @brief advance_populations
+ * matrix model with 5 stages (seeds -> germination -> height class 1 to 4) for every patch and both species
+ * - the factors and the counts stream from flat arrays, the patch objects are not touched
+ * - only occupied patches are visited, in index order, empty patches drew no random numbers before either
+ */
+void advance_populations(patch_grid& patches, const transition_factors& factors, std::mt19937& gen) {
+    population_store& populations = patches.get_populations();
+    int* N[N_stages][N_species];
+    stage_arrays(populations, N);
+    patches.for_each_occupied([&](size_t i) {
+        advance_patch_individuals(N, i, factors.of_patch(i), gen);
+        if (populations.is_empty(i)) {
+            patches.mark_empty(i);              // extinct, not visited again until new seeds arrive
+        }
+    });
+}
+
+void advance_populations(patch_grid& patches, const transition_factors& factors, std::uint64_t run_seed, int year) {
+    population_store& populations = patches.get_populations();
+    int* N[N_stages][N_species];
+    stage_arrays(populations, N);
+    patches.for_each_occupied([&](size_t i) {
+        philox4x32 patch_gen(run_seed, random_purpose::demography, year, i);
+        advance_patch_individuals(N, i, factors.of_patch(i), patch_gen);
+        if (populations.is_empty(i)) {
+            patches.mark_empty(i);
+        }
+    });
+}
+
+/**
+ * @brief transition_probability
+ * probability of rand_float_01(gen) < factor, so factors beyond [0, 1] and NaN (patches with a tree on them,
+ * where light availability is -inf) behave as in the per-individual draws
+ */
+float transition_probability(float factor) {
+    return factor > 0.0f ? std::min(factor, 1.0f) : 0.0f;
+}
+
+/**
+ * @brief binomial_table::build
+ * draws with probabilities above 0.5 count the failures instead, so p is at most 0.5
+ */
+void binomial_table::build(float factor) {
+    probability = transition_probability(factor);
+    flipped = probability > 0.5f;
+    p = flipped ? 1.0 - probability : probability;
+    q = 1.0 - p;
+    odds = p / q;
+    q_power.clear();
+    if (probability > 0.0f && probability < 1.0f) {
+        const int N_max = static_cast<int>(std::min(max_inversion_mean / p, 1024.0));   // cohorts drawn by inversion, at most 1024 cached
+        for (int N = 0; N <= N_max; N++) {
+            q_power.push_back(std::pow(q, N));
+        }
+    }
+}
+
+/**
+ * @brief advance_cohorts
+ * same stages, order and factors as advance_populations(), but each transition of a cohort is one binomial draw
+ * - a dying individual never grows and the survivors are drawn for growth once each, while the per-individual
+ *   procedure re-reads its loop bound after every draw, see the test for the resulting differences
+ */
+void advance_cohorts(patch_grid& patches, const transition_factors& factors, std::mt19937& gen) {
+    population_store& populations = patches.get_populations();
+    int* N[N_stages][N_species];
+    stage_arrays(populations, N);
+    patches.for_each_occupied([&](size_t i) {
+        advance_patch_cohorts(N, i, factors.of_patch(i), gen);
+        if (populations.is_empty(i)) {
+            patches.mark_empty(i);
+        }
+    });
+}
+
+void advance_cohorts(patch_grid& patches, const transition_factors& factors, std::uint64_t run_seed, int year) {
+    population_store& populations = patches.get_populations();
+    int* N[N_stages][N_species];
+    stage_arrays(populations, N);
+    patches.for_each_occupied([&](size_t i) {
+        philox4x32 patch_gen(run_seed, random_purpose::demography, year, i);
+        advance_patch_cohorts(N, i, factors.of_patch(i), patch_gen);
+        if (populations.is_empty(i)) {
+            patches.mark_empty(i);
+        }
+    });
+}
+
+/**
+ * @brief advance_tiles
+ * calls advance_patch(i) for every occupied patch, tile by tile across the threads of the pool
+ * - a patch only changes its own counts and draws from its own stream, so the order of the tiles does not matter
+ * - tiles are whole blocks of the occupancy bitmap, so marking an extinct patch as empty never touches a word
+ *   of another thread
+ * - the threads take the next free tile from a shared counter, sparse and dense parts of the map even out
+ */
+template <typename Function>
+static void advance_tiles(patch_grid& patches, thread_pool& pool, int tile_blocks, Function advance_patch) {
+    const size_t tile_size = std::max(tile_blocks, 1);
+    const size_t N_tiles = (patches.N_blocks() + tile_size - 1) / tile_size;
+    std::atomic<size_t> next_tile(0);
+    population_store& populations = patches.get_populations();
+    pool.run([&](int) {
+        for (size_t tile = next_tile++; tile < N_tiles; tile = next_tile++) {
+            const size_t first_block = tile * tile_size;
+            patches.for_each_occupied(first_block, std::min(first_block + tile_size, patches.N_blocks()), [&](size_t i) {
+                advance_patch(i);
+                if (populations.is_empty(i)) {
+                    patches.mark_empty(i);
+                }
+            });
+        }
+    });
+}
+
+void advance_populations_parallel(patch_grid& patches, const transition_factors& factors, std::uint64_t run_seed, int year,
+                                  thread_pool& pool, int tile_blocks) {
+    int* N[N_stages][N_species];
+    stage_arrays(patches.get_populations(), N);
+    advance_tiles(patches, pool, tile_blocks, [&](size_t i) {
+        philox4x32 patch_gen(run_seed, random_purpose::demography, year, i);
+        advance_patch_individuals(N, i, factors.of_patch(i), patch_gen);
+    });
+}
+
+void advance_cohorts_parallel(patch_grid& patches, const transition_factors& factors, std::uint64_t run_seed, int year,
+                              thread_pool& pool, int tile_blocks) {
+    int* N[N_stages][N_species];
+    stage_arrays(patches.get_populations(), N);
+    advance_tiles(patches, pool, tile_blocks, [&](size_t i) {
+        philox4x32 patch_gen(run_seed, random_purpose::demography, year, i);
+        advance_patch_cohorts(N, i, factors.of_patch(i), patch_gen);
+    });
+}
@@ -0,0 +1,109 @@
+#ifndef POPULATION_DYNAMICS_H
+#define POPULATION_DYNAMICS_H
+
+#include "patch_grid.h"
+#include "parallel.h"
+#include <cstdint>
+#include <vector>
+#include <random>
+
+/**
+ * Seed and sapling population dynamics working on the patch grid,
+ * kept outside of MainWindow so they can be tested and benchmarked without the ui.
+ */
+
+// demography procedures selectable in the ui, same order as the items of demography_mode_comboBox
+enum class demography_mode {
+    per_individual,     // one or two uniform draws for every seed and sapling, see advance_populations()
+    binomial_cohorts,   // one binomial draw per stage transition of a whole cohort, see advance_cohorts()
+    expected_values     // deterministic matrix model of the expected counts, see mean_field_populations.h
+};
+
+/**
+ * @brief The binomial_table class
+ * Parameters of the binomial draws with one transition factor, built once per environment class
+ * instead of in every draw: the clamped probability, the side of 0.5 it is drawn from and the
+ * start q^N of the inversion for small cohorts.
+ */
+class binomial_table {
+public:
+    void build(float factor);
+
+    float probability = 0.0f;                   // transition_probability() of the factor
+    bool flipped = false;                       // drawn as N minus the successes of 1 - probability
+    double p = 0.0;                             // probability of the drawn side, at most 0.5
+    double q = 1.0;
+    double odds = 0.0;                          // p / q
+    std::vector<double> q_power;                // q^N for the cohorts small enough to be drawn by inversion, up to a limit
+};
+
+// factors and binomial tables shared by all patches of one environment class
+struct environment_class_factors {
+    float mortality;                            // mortality_rate * (1 - light_availability) * (1 - water_availability)
+    float growth;                               // growth_rate * light_availability * water_availability
+    float germination_growth;                   // growth of height class 1 into 2, the plain growth_rate in the original model
+    binomial_table mortality_draws;
+    binomial_table growth_draws;
+    binomial_table germination_growth_draws;
+};
+
+/**
+ * @brief The transition_factors class
+ * Mortality and growth factors of every patch, same index as patch_grid::index().
+ * They only depend on the environment of the patch (light, water, rates), which is set up once,
+ * so they are computed before the first year and kept until the environment changes.
+ * Most patches share the same environment (full light and water away from the trees), so patches with
+ * identical factors form one environment class: the factors and binomial tables are kept once per class
+ * and a patch only stores the index of its class.
+ */
+class transition_factors {
+public:
+    void update(const patch_grid& patches);    // groups the patches into classes by the factors of their current environment
+    void invalidate();                          // to be called whenever light, water or the rates of the patches change
+    bool is_valid() const;
+
+    const environment_class_factors& of_patch(size_t i) const;
+    float mortality(size_t i) const;            // factors of patch i
+    float growth(size_t i) const;
+    float germination_growth(size_t i) const;
+    size_t N_classes() const;
+
+    std::vector<std::uint32_t> environment_class;   // class of every patch
+    std::vector<environment_class_factors> classes;
+
+private:
+    bool valid = false;
+};
+
+inline const environment_class_factors& transition_factors::of_patch(size_t i) const {
+    return classes[environment_class[i]];
+}
+
+// probability of a transition with the given factor, factors beyond [0, 1] and NaN behave as in the per-individual draws
+float transition_probability(float factor);
+
+// one year of mortality and growth of every seed and sapling, drawn one individual after the other as in the original model
+void advance_populations(patch_grid& patches,
+                         const transition_factors& factors,    // up to date factors of the patches
+                         std::mt19937& gen);                    // one stream for all patches in index order
+
+// same draws per patch, but every patch draws from its own philox4x32 stream keyed by the run seed, the year and its index,
+// so the result does not depend on the order or thread the patches are processed in, see sim_random.h
+void advance_populations(patch_grid& patches, const transition_factors& factors, std::uint64_t run_seed, int year);
+
+// one year of mortality and growth with binomial draws over the cohorts, the cost per patch does not grow with the populations
+// - stages from height class 4 down to the seeds, individuals advanced this year are not drawn again
+// - in each stage mortality first, then growth of the survivors, the rest stays
+void advance_cohorts(patch_grid& patches,
+                     const transition_factors& factors,
+                     std::mt19937& gen);
+void advance_cohorts(patch_grid& patches, const transition_factors& factors, std::uint64_t run_seed, int year);
+
+// same results as the per-patch stream procedures above for any number of threads: the grid is split into tiles of
+// tile_blocks * 64 patches in index order, which the threads of the pool take one after the other
+void advance_populations_parallel(patch_grid& patches, const transition_factors& factors, std::uint64_t run_seed, int year,
+                                  thread_pool& pool, int tile_blocks = 8);
+void advance_cohorts_parallel(patch_grid& patches, const transition_factors& factors, std::uint64_t run_seed, int year,
+                              thread_pool& pool, int tile_blocks = 8);
+
+#endif // POPULATION_DYNAMICS_H
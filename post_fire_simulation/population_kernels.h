@@ -0,0 +1,186 @@
+#ifndef POPULATION_KERNELS_H
+#define POPULATION_KERNELS_H
+
+#include "population_dynamics.h"
+#include "population_store.h"
+#include "sim_random.h"
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+/**
+ * Yearly mortality and growth of one patch for any number of species and stages of a basic_population_store.
+ * The stage loops have a constant trip count, so the compiler unrolls them for every configuration.
+ * population_dynamics.cpp runs them over the occupied patches of a patch_grid, the store procedures at
+ * the end run them over every patch of a store of another configuration.
+ */
+
+const double max_inversion_mean = 14.0;    // binomial draws with a smaller mean N * p are done by inversion
+
+/**
+ * @brief stage_arrays
+ * pointers to the count arrays of the store, N[stage][species][patch index]
+ */
+template <int NumSpecies, int NumStages>
+void stage_arrays(basic_population_store<NumSpecies, NumStages>& populations, int* (&N)[NumStages][NumSpecies]) {
+    for (int s = 0; s < NumStages; s++) {
+        for (int j = 0; j < NumSpecies; j++) {
+            N[s][j] = populations.counts(s, j);
+        }
+    }
+}
+
+/**
+ * @brief advance_stage
+ * mortality and growth of one stage, one individual after the other
+ * - the loop bound is re-read after every individual, and an individual may die and grow in the same year,
+ *   both exactly as in the original procedure
+ * @param N_next next stage receiving the grown individuals, nullptr for the last stage without growth
+ */
+template <class Engine>
+void advance_stage(int& N_stage, int* N_next, float mortality_factor, float growth_factor,
+                   Engine& gen, std::uniform_real_distribution<float>& rand_float_01) {
+    if (N_stage <= 0) {
+        return;                                 // only continue if there is at least 1 individual in the stage
+    }
+    for (int k = 0; k < N_stage; k++) {
+        if (rand_float_01(gen) < mortality_factor) {    // probability check for mortality
+            N_stage -= 1;                               // if passed, the individual dies
+        }
+        if (N_next != nullptr && rand_float_01(gen) < growth_factor) {  // probability check for growth
+            *N_next += 1;                               // if passed, the individual advances to the next stage
+            N_stage -= 1;                               // and is removed from this stage
+        }
+    }
+}
+
+/**
+ * @brief advance_patch_individuals
+ * one year of the per-individual draws of patch i
+ * - the last stage first, so saplings cannot advance two classes and die in the same year,
+ *   then down to the seeds
+ */
+template <int NumSpecies, int NumStages, class Engine>
+void advance_patch_individuals(int* (&N)[NumStages][NumSpecies], size_t i, const environment_class_factors& environment, Engine& gen) {
+    std::uniform_real_distribution<float> rand_float_01(0.0f, 1.0f);    // random float between 0 and 1 for seedling survival
+    for (int j = 0; j < NumSpecies; j++) {
+        for (int s = NumStages - 1; s >= 0; s--) {
+            switch (growth_of_stage<NumStages>(s)) {
+            case stage_growth::none:
+                advance_stage(N[s][j][i], nullptr, environment.mortality, 0.0f, gen, rand_float_01);
+                break;
+            case stage_growth::germination_growth:
+                advance_stage(N[s][j][i], &N[s + 1][j][i], environment.mortality, environment.germination_growth, gen, rand_float_01);
+                break;
+            case stage_growth::growth:
+                advance_stage(N[s][j][i], &N[s + 1][j][i], environment.mortality, environment.growth, gen, rand_float_01);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief draw_binomial
+ * number of successes among N trials of the probability of the table, from p or 1 - p whichever is smaller
+ * - small means N * p: inversion of the cumulative distribution from 0 upwards, one uniform draw
+ *   and on average about N * p steps
+ * - larger means: the rejection sampler of std::binomial_distribution, constant time for any N
+ */
+template <class Engine>
+int draw_binomial(int N, const binomial_table& table, Engine& gen) {
+    if (N <= 0 || table.probability <= 0.0f) {
+        return 0;
+    }
+    if (table.probability >= 1.0f) {
+        return N;
+    }
+    const double p = table.p;
+    int N_successes = 0;
+    if (N * p < max_inversion_mean) {
+        double probability_of_x = static_cast<size_t>(N) < table.q_power.size() ? table.q_power[N] : std::pow(table.q, N);   // P(X = 0)
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+        while (u > probability_of_x && N_successes < N) {
+            u -= probability_of_x;
+            N_successes++;
+            probability_of_x *= table.odds * (N - N_successes + 1) / N_successes;   // P(X = x) from P(X = x - 1)
+        }
+    } else {
+        std::binomial_distribution<int> binomial(N, p);
+        N_successes = binomial(gen);
+    }
+    return table.flipped ? N - N_successes : N_successes;
+}
+
+/**
+ * @brief advance_cohort
+ * multinomial split of a whole stage into dying, advancing and staying individuals from two binomial draws:
+ * N_dying ~ B(N, mortality), then N_advancing ~ B(N - N_dying, growth)
+ * @param N_next next stage receiving the grown individuals, nullptr for the last stage without growth
+ */
+template <class Engine>
+void advance_cohort(int& N_stage, int* N_next, const binomial_table& mortality, const binomial_table& growth, Engine& gen) {
+    if (N_stage <= 0) {
+        return;
+    }
+    const int N_dying = draw_binomial(N_stage, mortality, gen);
+    N_stage -= N_dying;
+    if (N_next != nullptr) {
+        const int N_advancing = draw_binomial(N_stage, growth, gen);
+        N_stage -= N_advancing;
+        *N_next += N_advancing;
+    }
+}
+
+/**
+ * @brief advance_patch_cohorts
+ * one year of the cohort draws of patch i, same stage order as advance_patch_individuals()
+ */
+template <int NumSpecies, int NumStages, class Engine>
+void advance_patch_cohorts(int* (&N)[NumStages][NumSpecies], size_t i, const environment_class_factors& environment, Engine& gen) {
+    for (int j = 0; j < NumSpecies; j++) {
+        for (int s = NumStages - 1; s >= 0; s--) {
+            switch (growth_of_stage<NumStages>(s)) {
+            case stage_growth::none:
+                advance_cohort(N[s][j][i], nullptr, environment.mortality_draws, environment.growth_draws, gen);
+                break;
+            case stage_growth::germination_growth:
+                advance_cohort(N[s][j][i], &N[s + 1][j][i], environment.mortality_draws, environment.germination_growth_draws, gen);
+                break;
+            case stage_growth::growth:
+                advance_cohort(N[s][j][i], &N[s + 1][j][i], environment.mortality_draws, environment.growth_draws, gen);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief advance_populations
+ * per-individual draws of every patch of a store, each patch from the same philox4x32 stream as in the
+ * patch_grid procedure; empty patches draw nothing, so no occupancy bitmap is needed for the same results
+ */
+template <int NumSpecies, int NumStages>
+void advance_populations(basic_population_store<NumSpecies, NumStages>& populations, const transition_factors& factors,
+                         std::uint64_t run_seed, int year) {
+    int* N[NumStages][NumSpecies];
+    stage_arrays(populations, N);
+    for (size_t i = 0; i < populations.size(); i++) {
+        philox4x32 patch_gen(run_seed, random_purpose::demography, year, i);
+        advance_patch_individuals(N, i, factors.of_patch(i), patch_gen);
+    }
+}
+
+// binomial cohort draws of every patch of a store, see above
+template <int NumSpecies, int NumStages>
+void advance_cohorts(basic_population_store<NumSpecies, NumStages>& populations, const transition_factors& factors,
+                     std::uint64_t run_seed, int year) {
+    int* N[NumStages][NumSpecies];
+    stage_arrays(populations, N);
+    for (size_t i = 0; i < populations.size(); i++) {
+        philox4x32 patch_gen(run_seed, random_purpose::demography, year, i);
+        advance_patch_cohorts(N, i, factors.of_patch(i), patch_gen);
+    }
+}
+
+#endif // POPULATION_KERNELS_H
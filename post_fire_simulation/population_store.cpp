@@ -0,0 +1,8 @@
+/**
+ * POPULATION STORE CLASS
+ */
+
+#include "population_store.h"
+
+// the store of the model is compiled once here, other configurations are instantiated where they are used
+template class basic_population_store<N_species, N_stages>;
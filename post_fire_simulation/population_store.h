@@ -0,0 +1,71 @@
+#ifndef POPULATION_STORE_H
+#define POPULATION_STORE_H
+
+#include "population_traits.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief The basic_population_store class
+ * Seed and sapling counts of all patches as structure of arrays: one contiguous array per stage and species,
+ * indexed like patch_grid::index(), so a procedure working on one stage streams through memory
+ * instead of visiting ten small vectors per patch. The patches of a patch_grid are views of this store.
+ * The number of species and stages are template parameters, so loops over them have a constant trip count;
+ * the model itself uses population_store with the species and stages of population_traits.h.
+ */
+template <int NumSpecies, int NumStages>
+class basic_population_store {
+public:
+    static constexpr int N_species = NumSpecies;
+    static constexpr int N_stages = NumStages;
+
+    void reset(size_t N_patches);                   // resizes the store and sets all counts to 0
+
+    int* counts(int stage, int species);            // array of the counts of all patches
+    const int* counts(int stage, int species) const;
+    bool is_empty(size_t i) const;                  // true if patch i holds no seeds or saplings
+    size_t size() const;                            // number of patches
+
+private:
+    size_t N_patches = 0;
+    std::vector<int> data;                          // [stage][species][patch]
+};
+
+typedef basic_population_store<N_species, N_stages> population_store;
+
+template <int NumSpecies, int NumStages>
+void basic_population_store<NumSpecies, NumStages>::reset(size_t N_patches) {
+    this->N_patches = N_patches;
+    data.assign(NumStages * NumSpecies * N_patches, 0);
+}
+
+template <int NumSpecies, int NumStages>
+int* basic_population_store<NumSpecies, NumStages>::counts(int stage, int species) {
+    return data.data() + (stage * NumSpecies + species) * N_patches;
+}
+
+template <int NumSpecies, int NumStages>
+const int* basic_population_store<NumSpecies, NumStages>::counts(int stage, int species) const {
+    return data.data() + (stage * NumSpecies + species) * N_patches;
+}
+
+/**
+ * @brief basic_population_store::is_empty
+ * patches with negative counts are not empty
+ */
+template <int NumSpecies, int NumStages>
+bool basic_population_store<NumSpecies, NumStages>::is_empty(size_t i) const {
+    for (int k = 0; k < NumStages * NumSpecies; k++) {
+        if (data[k * N_patches + i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <int NumSpecies, int NumStages>
+size_t basic_population_store<NumSpecies, NumStages>::size() const {
+    return N_patches;
+}
+
+#endif // POPULATION_STORE_H
@@ -0,0 +1,61 @@
+#ifndef POPULATION_TRAITS_H
+#define POPULATION_TRAITS_H
+
+/**
+ * Species and stages of the population model as compile-time tables, so the shape of the model is
+ * written down in one place and every loop over species and stages has a constant trip count.
+ */
+
+// stages of the population model, first index of the population store
+enum population_stage {
+    stage_seeds = 0,
+    stage_height_class_1,
+    stage_height_class_2,
+    stage_height_class_3,
+    stage_height_class_4
+};
+
+// transition factor moving the individuals of a stage on to the next one
+enum class stage_growth {
+    growth,                 // growth factor of the patch
+    germination_growth,     // growth of height class 1 into 2, the plain growth_rate in the original model
+    none                    // last stage, individuals only die
+};
+
+/**
+ * @brief growth_of_stage
+ * the last stage does not grow and height class 1 grows with the germination growth,
+ * which holds for any number of stages of a configuration
+ */
+template <int NumStages>
+constexpr stage_growth growth_of_stage(int stage) {
+    return stage == NumStages - 1 ? stage_growth::none
+         : stage == stage_height_class_1 ? stage_growth::germination_growth
+         : stage_growth::growth;
+}
+
+// parameters of one species of the model
+struct species_traits {
+    char code;                  // species of the trees and patch::update_N_seeds(), "b" for birch, "o" for oak
+    const char* name;           // name in the titles of the charts
+    int dispersal_factor;       // of the trees, see tree::update_species_params()
+    int max_seed_production;    // seeds a tree disperses in each time step
+};
+
+constexpr species_traits model_species[] = {
+    {'b', "Birch", 20, 50},     // index 0
+    {'o', "Oak", 40, 100}       // index 1
+};
+
+const int N_species = sizeof(model_species) / sizeof(model_species[0]);
+
+constexpr const char* stage_names[] = {"Seeds", "Height class 1", "Height class 2", "Height class 3", "Height class 4"};
+
+const int N_stages = sizeof(stage_names) / sizeof(stage_names[0]);
+
+// index of the species with the given code in model_species, -1 for unknown codes
+constexpr int species_index(char code, int first = 0) {
+    return first == N_species ? -1 : model_species[first].code == code ? first : species_index(code, first + 1);
+}
+
+#endif // POPULATION_TRAITS_H
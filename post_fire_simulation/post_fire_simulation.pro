@@ -9,15 +9,53 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    alias_table.cpp \
+    analysis_pipeline.cpp \
+    canopy_shading.cpp \
+    dispersal.cpp \
+    dispersal_stencil.cpp \
+    distance_field.cpp \
+    distance_transform.cpp \
+    fft.cpp \
     main.cpp \
     mainwindow.cpp \
+    mean_field_populations.cpp \
+    parallel.cpp \
     patch.cpp \
-    tree.cpp
+    patch_grid.cpp \
+    population_dynamics.cpp \
+    population_store.cpp \
+    seed_rain_field.cpp \
+    seed_trajectory.cpp \
+    tree.cpp \
+    tree_index.cpp \
+    year_step.cpp
 
 HEADERS += \
+    alias_table.h \
+    analysis_pipeline.h \
+    canopy_shading.h \
+    dispersal.h \
+    dispersal_kernel.h \
+    dispersal_stencil.h \
+    distance_field.h \
+    distance_transform.h \
+    fft.h \
     mainwindow.h \
+    mean_field_populations.h \
+    parallel.h \
     patch.h \
-    tree.h
+    patch_grid.h \
+    population_dynamics.h \
+    population_kernels.h \
+    population_store.h \
+    population_traits.h \
+    seed_rain_field.h \
+    seed_trajectory.h \
+    sim_random.h \
+    tree.h \
+    tree_index.h \
+    year_step.h
 
 FORMS += \
     mainwindow.ui
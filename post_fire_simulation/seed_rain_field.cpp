@@ -0,0 +1,287 @@
+/**
+ * SEED RAIN FIELD CLASS
+ */
+
+#include "seed_rain_field.h"
+#include "fft.h"
+#include "sim_random.h"
+#include <cmath>
+#include <complex>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <random>
+
+/**
+ * @brief seed_rain_field::expected_seed_stencil
+ * expected number of seeds landing at each offset around a tree in one year, following disperse_seeds():
+ * - the real seed production n = int(max_seed_production * U) is uniform in 0 .. max_seed_production - 1
+ * - seed i of n is thrown in direction 2 * pi * i / n
+ * - the distance of the dispersal kernel is integrated with dispersal_stencil::distance_quadrature(), fine enough
+ *   to resolve the truncation of the offsets to whole patches
+ * @param dispersal species parameters and dispersal kernel
+ * @return (2r + 1)^2 expected counts with r = max_distance(), offset (dx, dy) at (dx + r) * (2r + 1) + (dy + r)
+ */
+std::vector<float> seed_rain_field::expected_seed_stencil(const dispersal_stencil& dispersal) {
+    const int r = dispersal.max_distance();
+    const int width = 2 * r + 1;
+    const int max_seed_production = dispersal.max_seed_production;
+    std::vector<double> stencil(width * width, 0.0);
+
+    std::vector<float> distance;                                        // distance samples per seed direction
+    std::vector<double> distance_weight;
+    dispersal.distance_quadrature(distance, distance_weight);
+
+    for (int n = 1; n < max_seed_production; n++) {
+        for (int i = 1; i <= n; i++) {
+            float direction = 2 * M_PI * i / n;
+            for (size_t q = 0; q < distance.size(); q++) {
+                int offset_x = static_cast<int>(distance[q] * cos(direction));
+                int offset_y = static_cast<int>(distance[q] * sin(direction));
+                stencil[(offset_x + r) * width + (offset_y + r)] += distance_weight[q] / max_seed_production;   // P(n) * quadrature weight
+            }
+        }
+    }
+    return std::vector<float>(stencil.begin(), stencil.end());
+}
+
+/**
+ * @brief seed_rain_field::get_stencil
+ * expected seed stencil for the given species parameters and kernel, computed on first use and cached afterwards
+ */
+const std::vector<float>& seed_rain_field::get_stencil(const dispersal_stencil& dispersal) {
+    stencil_key key(static_cast<int>(dispersal.kernel), dispersal.dispersal_factor, dispersal.max_seed_production,
+                    dispersal.long_distance_share, dispersal.long_distance_range);
+    if (stencils.find(key) == stencils.end()) {
+        stencils[key] = expected_seed_stencil(dispersal);
+    }
+    return stencils[key];
+}
+
+/**
+ * @brief seed_rain_field::build
+ * stamps the expected seed stencil of every unburnt tree onto the map,
+ * stencils are computed once per species parameter set and kernel as all trees of a species share them
+ */
+void seed_rain_field::build(const std::vector<tree>& trees, const dispersal_stencil_set& dispersal_stencils, int x_size, int y_size) {
+    this->x_size = x_size;
+    this->y_size = y_size;
+    for (auto& species_intensity : intensity) {
+        species_intensity.assign(x_size * y_size, 0.0f);
+    }
+
+    for (auto& t : trees) {
+        if (t.burnt) {
+            continue;                                                   // burnt trees do not disperse seeds
+        }
+        const dispersal_stencil& dispersal = dispersal_stencils.for_species(t.species);
+        const std::vector<float>& stencil = get_stencil(dispersal);
+        const int r = dispersal.max_distance();
+        const int width = 2 * r + 1;
+        std::vector<float>& species_intensity = intensity[species_index(t.species)];
+
+        for (int dx = -r; dx <= r; dx++) {
+            int x = t.x_y_cor[0] + dx;
+            if (x < 0 || x >= x_size) {
+                continue;                                               // seeds leaving the map are lost as in disperse_seeds()
+            }
+            for (int dy = -r; dy <= r; dy++) {
+                int y = t.x_y_cor[1] + dy;
+                if (y >= 0 && y < y_size) {
+                    species_intensity[x * y_size + y] += stencil[(dx + r) * width + (dy + r)];
+                }
+            }
+        }
+    }
+    update_source_patches();
+}
+
+/**
+ * @brief seed_rain_field::build_by_convolution
+ * same field as build(), but computed as a convolution of the tree raster with the seed stencil via FFT
+ * - trees are rasterised per species (number of unburnt trees per patch)
+ * - the raster is zero padded to a power of two of at least map + stencil radius, so the circular
+ *   convolution does not wrap seeds around the map edges
+ * - the cost is O(N log N) in padded patches and does not depend on the number of trees,
+ *   which pays off for dense stands where thousands of seed shadows overlap
+ * - the stencil spectra are cached, only the tree raster is transformed on each call
+ */
+void seed_rain_field::build_by_convolution(const std::vector<tree>& trees, const dispersal_stencil_set& dispersal_stencils, int x_size, int y_size) {
+    this->x_size = x_size;
+    this->y_size = y_size;
+    for (auto& species_intensity : intensity) {
+        species_intensity.assign(x_size * y_size, 0.0f);
+    }
+
+    // group the trees by species, each group needs one convolution
+    std::map<char, std::vector<const tree*>> groups;
+    for (auto& t : trees) {
+        if (t.burnt == false) {
+            groups[t.species].push_back(&t);
+        }
+    }
+
+    for (auto& group : groups) {
+        const dispersal_stencil& dispersal = dispersal_stencils.for_species(group.first);
+        const int r = dispersal.max_distance();
+        const int width = 2 * r + 1;
+        const int nx = next_power_of_two(x_size + r);
+        const int ny = next_power_of_two(y_size + r);
+
+        // spectrum of the stencil with its center at the origin, negative offsets wrapped to the end
+        std::vector<std::complex<double>>& kernel = kernel_spectra[std::make_tuple(static_cast<int>(dispersal.kernel),
+            dispersal.dispersal_factor, dispersal.max_seed_production, dispersal.long_distance_share, dispersal.long_distance_range, nx, ny)];
+        if (kernel.empty()) {
+            const std::vector<float>& stencil = get_stencil(dispersal);
+            kernel.assign(nx * ny, 0.0);
+            for (int dx = -r; dx <= r; dx++) {
+                for (int dy = -r; dy <= r; dy++) {
+                    kernel[((dx + nx) % nx) * ny + (dy + ny) % ny] = stencil[(dx + r) * width + (dy + r)];
+                }
+            }
+            fft_2d(kernel, nx, ny, false);
+        }
+
+        // tree raster, convolution as pointwise product of the spectra
+        std::vector<std::complex<double>> raster(nx * ny, 0.0);
+        for (const tree* t : group.second) {
+            raster[t->x_y_cor[0] * ny + t->x_y_cor[1]] += 1.0;
+        }
+        fft_2d(raster, nx, ny, false);
+        for (int i = 0; i < nx * ny; i++) {
+            raster[i] *= kernel[i];
+        }
+        fft_2d(raster, nx, ny, true);
+
+        // crop to the map, drop the rounding noise of the transforms
+        std::vector<float>& species_intensity = intensity[species_index(group.second.front()->species)];
+        for (int x = 0; x < x_size; x++) {
+            for (int y = 0; y < y_size; y++) {
+                double value = raster[x * ny + y].real();
+                if (value > convolution_noise_level) {
+                    species_intensity[x * y_size + y] += value;
+                }
+            }
+        }
+    }
+    update_source_patches();
+}
+
+/**
+ * @brief seed_rain_field::update_source_patches
+ * collects the patches with a non-zero intensity and caches exp(-intensity) for the Poisson inversion in draw_seeds()
+ */
+void seed_rain_field::update_source_patches() {
+    source_patches.clear();
+    source_bits.assign((x_size * y_size + 63) / 64, 0);
+    for (int i = 0; i < x_size * y_size; i++) {
+        for (int s = 0; s < N_species; s++) {
+            if (intensity[s][i] > 0) {
+                source_patches.push_back(i);
+                source_bits[i / 64] |= std::uint64_t(1) << (i % 64);
+                break;
+            }
+        }
+    }
+    for (int s = 0; s < N_species; s++) {
+        exp_neg_intensity[s].resize(intensity[s].size());
+        for (size_t i = 0; i < intensity[s].size(); i++) {
+            exp_neg_intensity[s][i] = std::exp(-static_cast<double>(intensity[s][i]));
+        }
+    }
+}
+
+/**
+ * @brief draw_poisson
+ * Poisson distributed number of seeds with the given mean
+ * - small means are drawn by inversion with the cached exp(-intensity), which needs about intensity + 1 steps
+ * - large means (dense stands) fall back to the standard library distribution
+ */
+template <class Engine>
+static int draw_poisson(float mean, double exp_neg_mean, double max_inversion_mean, Engine& gen) {
+    int N_seeds = 0;
+    if (mean < max_inversion_mean) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+        double probability = exp_neg_mean;      // P(N = 0)
+        double cumulative = probability;
+        while (u > cumulative && probability > 0) {
+            N_seeds++;
+            probability *= mean / N_seeds;
+            cumulative += probability;
+        }
+    } else {
+        std::poisson_distribution<int> rand_N_seeds(mean);
+        N_seeds = rand_N_seeds(gen);
+    }
+    return N_seeds;
+}
+
+/**
+ * @brief seed_rain_field::draw_seeds
+ * one year of seed arrivals, the number of seeds per patch and species is Poisson distributed
+ * with the cached intensity as mean, no per-seed trajectories are simulated
+ */
+void seed_rain_field::draw_seeds(patch_grid& patches, std::mt19937& gen) const {
+    population_store& populations = patches.get_populations();
+    for (int i : source_patches) {
+        for (int s = 0; s < N_species; s++) {
+            const float mean = intensity[s][i];
+            if (mean <= 0) {
+                continue;
+            }
+            int N_seeds = draw_poisson(mean, exp_neg_intensity[s][i], max_inversion_intensity, gen);
+            if (N_seeds > 0) {
+                populations.counts(stage_seeds, s)[i] += N_seeds;
+                patches.mark_occupied(i);
+            }
+        }
+    }
+}
+
+/**
+ * @brief seed_rain_field::draw_seeds
+ * same draws, but each patch draws all species from its own stream keyed by the run seed, the year and its index
+ */
+void seed_rain_field::draw_seeds(patch_grid& patches, std::uint64_t run_seed, int year) const {
+    population_store& populations = patches.get_populations();
+    for (int i : source_patches) {
+        int N_seeds[N_species];
+        draw_patch_seeds(i, run_seed, year, N_seeds);
+        for (int s = 0; s < N_species; s++) {
+            if (N_seeds[s] > 0) {
+                populations.counts(stage_seeds, s)[i] += N_seeds[s];
+                patches.mark_occupied(i);
+            }
+        }
+    }
+}
+
+/**
+ * @brief seed_rain_field::draw_patch_seeds
+ * all species of one patch from the stream of the patch, for procedures visiting the patches themselves
+ * @param N_seeds receives the number of seeds arriving per species, same order as model_species
+ */
+void seed_rain_field::draw_patch_seeds(size_t i, std::uint64_t run_seed, int year, int N_seeds[N_species]) const {
+    philox4x32 patch_gen(run_seed, random_purpose::seed_rain, year, i);
+    for (int s = 0; s < N_species; s++) {
+        const float mean = intensity[s][i];
+        N_seeds[s] = mean > 0 ? draw_poisson(mean, exp_neg_intensity[s][i], max_inversion_intensity, patch_gen) : 0;
+    }
+}
+
+std::uint64_t seed_rain_field::source_block(size_t block) const {
+    return block < source_bits.size() ? source_bits[block] : 0;
+}
+
+float seed_rain_field::get_intensity(int x, int y, int species) const {
+    return intensity[species][x * y_size + y];
+}
+
+float seed_rain_field::get_total_intensity(int species) const {
+    double total = 0;
+    for (float value : intensity[species]) {
+        total += value;
+    }
+    return total;
+}
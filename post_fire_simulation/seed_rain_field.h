@@ -0,0 +1,58 @@
+#ifndef SEED_RAIN_FIELD_H
+#define SEED_RAIN_FIELD_H
+
+#include "tree.h"
+#include "patch_grid.h"
+#include "dispersal_stencil.h"
+#include <complex>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <random>
+
+/**
+ * @brief The seed_rain_field class
+ * Expected annual number of seeds per patch and species for a stand whose trees do not change.
+ * The field is built once after setup and replaces the per-seed trajectories of disperse_seeds()
+ * with one Poisson draw per patch and species each year. For dense stands the field can be built
+ * as an FFT convolution of the tree raster with the seed stencil instead of stamping every tree.
+ */
+class seed_rain_field {
+public:
+    // Member functions
+    void build(const std::vector<tree>& trees,                              // sums the expected seed shadows of all unburnt trees
+               const dispersal_stencil_set& dispersal_stencils, int x_size, int y_size);
+    void build_by_convolution(const std::vector<tree>& trees,               // same field via FFT, cost independent of the number of trees
+                              const dispersal_stencil_set& dispersal_stencils, int x_size, int y_size);
+    void draw_seeds(patch_grid& patches, std::mt19937& gen) const;         // draws one year of seed arrivals into the patches
+    void draw_seeds(patch_grid& patches, std::uint64_t run_seed, int year) const;  // same from one philox4x32 stream per patch
+    void draw_patch_seeds(size_t i, std::uint64_t run_seed, int year, int N_seeds[N_species]) const;   // seeds of patch i drawn by draw_seeds() in that year
+    std::uint64_t source_block(size_t block) const;                        // bit b set if patch 64 * block + b may receive seeds
+    float get_intensity(int x, int y, int species) const;                   // expected seeds per year, species 0 birch and 1 oak
+    float get_total_intensity(int species) const;                           // expected seeds per year on the whole map
+
+    // expected seeds per year around a single tree as (2 * max_distance + 1)^2 offsets, row index is the x offset
+    static std::vector<float> expected_seed_stencil(const dispersal_stencil& dispersal);
+
+private:
+    const std::vector<float>& get_stencil(const dispersal_stencil& dispersal);
+    void update_source_patches();
+
+    int x_size = 0;
+    int y_size = 0;
+    std::vector<float> intensity[N_species];    // per patch intensity, same index as patch_grid::index()
+    std::vector<double> exp_neg_intensity[N_species];   // cached exp(-intensity), probability of no seed arriving
+    static constexpr float max_inversion_intensity = 30.0f;    // above this mean the Poisson draw is not done by inversion
+    static constexpr double convolution_noise_level = 1e-9;     // FFT rounding noise below this is treated as no seed rain
+
+    // key: dispersal kernel, dispersal factor, max seed production, long-distance share and range
+    typedef std::tuple<int, int, int, float, int> stencil_key;
+    std::map<stencil_key, std::vector<float>> stencils;
+    std::map<std::tuple<int, int, int, float, int, int, int>, std::vector<std::complex<double>>> kernel_spectra;    // key: stencil key and padded size
+    std::vector<int> source_patches;        // patches with a non-zero intensity of any species, the only ones visited each year
+    std::vector<std::uint64_t> source_bits; // same patches as a bitmap in blocks of 64 like the occupancy of patch_grid
+};
+
+#endif // SEED_RAIN_FIELD_H
@@ -0,0 +1,239 @@
+/**
+ * SEED TRAJECTORY KERNEL
+ */
+
+// the vector and scalar kernels must round identically, so multiply-add pairs are never fused
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include "seed_trajectory.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SEED_TRAJECTORY_X86 1
+#include <immintrin.h>
+#endif
+
+// constants shared by all kernels
+static const float two_pi = 6.28318530717958647692f;
+static const float two_over_pi = 0.63661977236758134308f;
+static const float pi_over_2_hi = 1.5707963705062866211f;         // pi / 2 split in two floats for an exact range reduction
+static const float pi_over_2_lo = -4.3711390001862428e-8f;
+// Taylor series of 2^f on [-0.5, 0.5], ln(2)^n / n!
+static const float exp2_c1 = 0.693147180559945f;
+static const float exp2_c2 = 0.240226506959101f;
+static const float exp2_c3 = 0.0555041086648216f;
+static const float exp2_c4 = 0.00961812910762848f;
+static const float exp2_c5 = 0.00133335581464284f;
+static const float exp2_c6 = 0.000154035303933816f;
+// minimax polynomials of sin and cos on [-pi / 4, pi / 4] (Cephes sinf / cosf)
+static const float sin_c1 = -1.6666654611e-1f;
+static const float sin_c2 = 8.3321608736e-3f;
+static const float sin_c3 = -1.9515295891e-4f;
+static const float cos_c1 = 4.166664568298827e-2f;
+static const float cos_c2 = -1.388731625493765e-3f;
+static const float cos_c3 = 2.443315711809948e-5f;
+
+/**
+ * @brief direction_sincos
+ * sine and cosine of the direction 2 * pi * i / N_seeds of seed i = 1 .. N_seeds,
+ * reduced to r in [-pi / 4, pi / 4] and quadrant q and evaluated with float polynomials
+ */
+void direction_sincos(int i, int N_seeds, float& sin_direction, float& cos_direction) {
+    const float step = two_pi / static_cast<float>(N_seeds);
+    float direction = static_cast<float>(i) * step;
+    float j = std::nearbyint(direction * two_over_pi);
+    float r = direction - j * pi_over_2_hi;
+    r = r - j * pi_over_2_lo;
+    float z = r * r;
+    float sin_r = ((sin_c3 * z + sin_c2) * z + sin_c1) * z * r + r;
+    float cos_r = ((cos_c3 * z + cos_c2) * z + cos_c1) * z * z - 0.5f * z + 1.0f;
+    int q = static_cast<int>(j);
+    sin_direction = (q & 1) ? cos_r : sin_r;
+    cos_direction = (q & 1) ? sin_r : cos_r;
+    if (q & 2) {
+        sin_direction = -sin_direction;
+    }
+    if ((q + 1) & 2) {
+        cos_direction = -cos_direction;
+    }
+}
+
+/**
+ * @brief seed_offsets_scalar
+ * reference kernel for the seeds first .. last - 1, every vector kernel below performs exactly these float operations per lane
+ */
+static void seed_offsets_scalar(seed_batch& batch, float factor, const float* cos_directions, const float* sin_directions, int first, int last) {
+    for (int i = first; i < last; i++) {
+        // distance decay 2^(-3u) = 2^k * 2^f with k = round(-3u)
+        float t = batch.uniforms[i] * -3.0f;
+        float k = std::nearbyint(t);
+        float f = t - k;
+        float p = exp2_c6;
+        p = p * f + exp2_c5;
+        p = p * f + exp2_c4;
+        p = p * f + exp2_c3;
+        p = p * f + exp2_c2;
+        p = p * f + exp2_c1;
+        p = p * f + 1.0f;
+        std::int32_t scale_bits = (static_cast<std::int32_t>(k) + 127) << 23;
+        float scale;
+        std::memcpy(&scale, &scale_bits, sizeof(scale));
+        float distance = factor * (p * scale);
+
+        batch.offset_x[i] = static_cast<int>(distance * cos_directions[i]);
+        batch.offset_y[i] = static_cast<int>(distance * sin_directions[i]);
+    }
+}
+
+#ifdef SEED_TRAJECTORY_X86
+
+/**
+ * @brief seed_offsets_avx2
+ * 8 seeds per iteration, the remaining seeds are done by the scalar kernel
+ */
+__attribute__((target("avx2")))
+static void seed_offsets_avx2(seed_batch& batch, float dispersal_factor, const float* cos_directions, const float* sin_directions) {
+    const int N_vector = batch.N_seeds / 8 * 8;
+    const __m256 factor = _mm256_set1_ps(dispersal_factor);
+    const int rounding = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+
+    for (int i = 0; i < N_vector; i += 8) {
+        __m256 t = _mm256_mul_ps(_mm256_loadu_ps(&batch.uniforms[i]), _mm256_set1_ps(-3.0f));
+        __m256 k = _mm256_round_ps(t, rounding);
+        __m256 f = _mm256_sub_ps(t, k);
+        __m256 p = _mm256_set1_ps(exp2_c6);
+        p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(exp2_c5));
+        p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(exp2_c4));
+        p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(exp2_c3));
+        p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(exp2_c2));
+        p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(exp2_c1));
+        p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(1.0f));
+        __m256i scale_bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(k), _mm256_set1_epi32(127)), 23);
+        __m256 distance = _mm256_mul_ps(factor, _mm256_mul_ps(p, _mm256_castsi256_ps(scale_bits)));
+
+        __m256 cos_direction = _mm256_loadu_ps(&cos_directions[i]);
+        __m256 sin_direction = _mm256_loadu_ps(&sin_directions[i]);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&batch.offset_x[i]), _mm256_cvttps_epi32(_mm256_mul_ps(distance, cos_direction)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&batch.offset_y[i]), _mm256_cvttps_epi32(_mm256_mul_ps(distance, sin_direction)));
+    }
+    seed_offsets_scalar(batch, dispersal_factor, cos_directions, sin_directions, N_vector, batch.N_seeds);
+}
+
+/**
+ * @brief seed_offsets_avx512
+ * 16 seeds per iteration, the remaining seeds are done by the scalar kernel
+ */
+__attribute__((target("avx512f")))
+static void seed_offsets_avx512(seed_batch& batch, float dispersal_factor, const float* cos_directions, const float* sin_directions) {
+    const int N_vector = batch.N_seeds / 16 * 16;
+    const __m512 factor = _mm512_set1_ps(dispersal_factor);
+    const int rounding = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+
+    for (int i = 0; i < N_vector; i += 16) {
+        __m512 t = _mm512_mul_ps(_mm512_loadu_ps(&batch.uniforms[i]), _mm512_set1_ps(-3.0f));
+        __m512 k = _mm512_roundscale_ps(t, rounding);
+        __m512 f = _mm512_sub_ps(t, k);
+        __m512 p = _mm512_set1_ps(exp2_c6);
+        p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(exp2_c5));
+        p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(exp2_c4));
+        p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(exp2_c3));
+        p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(exp2_c2));
+        p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(exp2_c1));
+        p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(1.0f));
+        __m512i scale_bits = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvttps_epi32(k), _mm512_set1_epi32(127)), 23);
+        __m512 distance = _mm512_mul_ps(factor, _mm512_mul_ps(p, _mm512_castsi512_ps(scale_bits)));
+
+        __m512 cos_direction = _mm512_loadu_ps(&cos_directions[i]);
+        __m512 sin_direction = _mm512_loadu_ps(&sin_directions[i]);
+
+        _mm512_storeu_si512(&batch.offset_x[i], _mm512_cvttps_epi32(_mm512_mul_ps(distance, cos_direction)));
+        _mm512_storeu_si512(&batch.offset_y[i], _mm512_cvttps_epi32(_mm512_mul_ps(distance, sin_direction)));
+    }
+    seed_offsets_scalar(batch, dispersal_factor, cos_directions, sin_directions, N_vector, batch.N_seeds);
+}
+
+#endif // SEED_TRAJECTORY_X86
+
+/**
+ * @brief detected_simd_level
+ * @return best instruction set of the cpu this program runs on, checked once
+ */
+simd_level detected_simd_level() {
+#ifdef SEED_TRAJECTORY_X86
+    static const simd_level level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return simd_level::avx512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return simd_level::avx2;
+        }
+        return simd_level::scalar;
+    }();
+    return level;
+#else
+    return simd_level::scalar;
+#endif
+}
+
+const char* simd_level_name(simd_level level) {
+    switch (level) {
+    case simd_level::avx512:
+        return "AVX-512";
+    case simd_level::avx2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
+
+void seed_batch::resize(int N_seeds) {
+    this->N_seeds = N_seeds;
+    if (static_cast<int>(uniforms.size()) < N_seeds) {
+        random_bits.resize(N_seeds);
+        uniforms.resize(N_seeds);
+        offset_x.resize(N_seeds);
+        offset_y.resize(N_seeds);
+    }
+}
+
+/**
+ * @brief seed_batch::draw
+ * one engine output per seed, the uniform of the seed is its upper 24 bits as in uniform_float(gen)
+ */
+void seed_batch::draw(int N_seeds, splitmix64& gen) {
+    resize(N_seeds);
+    for (int i = 0; i < N_seeds; i++) {
+        random_bits[i] = gen();
+        uniforms[i] = uniform_float(random_bits[i]);
+    }
+}
+
+/**
+ * @brief generate_seed_offsets
+ * landing offsets of all seeds in the batch with the given kernel, which must be supported by the cpu
+ */
+void generate_seed_offsets(seed_batch& batch, int dispersal_factor, const float* cos_directions, const float* sin_directions, simd_level level) {
+    const float factor = static_cast<float>(dispersal_factor);
+#ifdef SEED_TRAJECTORY_X86
+    if (level == simd_level::avx512) {
+        seed_offsets_avx512(batch, factor, cos_directions, sin_directions);
+        return;
+    }
+    if (level == simd_level::avx2) {
+        seed_offsets_avx2(batch, factor, cos_directions, sin_directions);
+        return;
+    }
+#else
+    (void)level;
+#endif
+    seed_offsets_scalar(batch, factor, cos_directions, sin_directions, 0, batch.N_seeds);
+}
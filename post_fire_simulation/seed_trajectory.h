@@ -0,0 +1,55 @@
+#ifndef SEED_TRAJECTORY_H
+#define SEED_TRAJECTORY_H
+
+#include "sim_random.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * Batch kernel for the seed trajectories of one tree: landing offsets of all seeds are computed at once
+ * from a flat buffer of uniforms with a polynomial exp2 for the distance decay, the seed directions come
+ * from the precomputed tables of a dispersal_stencil. The kernel is dispatched at runtime to AVX-512, AVX2
+ * or a scalar fallback. All three use the same float operations in the same order (no fused multiply-add),
+ * so the offsets are bit-identical on every machine.
+ */
+
+// instruction sets of the trajectory kernel, ordered from the slowest to the fastest
+enum class simd_level {
+    scalar,
+    avx2,
+    avx512
+};
+
+simd_level detected_simd_level();                   // best instruction set supported by this cpu
+const char* simd_level_name(simd_level level);
+
+// flat buffers for the seeds of one tree, kept per thread to avoid allocations in the yearly loop
+class seed_batch {
+public:
+    void resize(int N_seeds);
+    void draw(int N_seeds, splitmix64& gen);        // resizes and draws the random bits and uniforms of all seeds
+
+    int N_seeds = 0;
+    std::vector<std::uint64_t> random_bits;         // one engine output per seed, the alias table of a long-distance tail uses all 64 bits
+    std::vector<float> uniforms;                    // one uniform per seed for the distance decay, the upper 24 bits of random_bits
+    std::vector<int> offset_x;                      // landing offsets relative to the mother tree
+    std::vector<int> offset_y;
+};
+
+// offsets of seed i = 1 .. N_seeds at distance dispersal_factor * 2^(-3 * uniforms[i - 1]) in the direction given by
+// cos_directions[i - 1] and sin_directions[i - 1], the level must be supported by the cpu
+void generate_seed_offsets(seed_batch& batch, int dispersal_factor, const float* cos_directions, const float* sin_directions, simd_level level);
+
+// sine and cosine of the direction 2 * pi * i / N_seeds of seed i as float polynomials, used to fill the direction tables
+void direction_sincos(int i, int N_seeds, float& sin_direction, float& cos_direction);
+
+// uniform float in [0, 1) from the upper 24 bits of an engine output
+inline float uniform_float(std::uint64_t random_bits) {
+    return static_cast<float>(random_bits >> 40) * (1.0f / 16777216.0f);
+}
+
+inline float uniform_float(splitmix64& gen) {
+    return uniform_float(gen());
+}
+
+#endif // SEED_TRAJECTORY_H
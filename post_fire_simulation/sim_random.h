@@ -0,0 +1,101 @@
+#ifndef SIM_RANDOM_H
+#define SIM_RANDOM_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief The splitmix64 class
+ * Small random number engine used for independent per-tree streams in the parallel dispersal.
+ * Every tree gets its own engine keyed by the yearly dispersal seed and the tree id, so the seeds of a tree
+ * are the same no matter which thread processes it. Usable with the standard library distributions.
+ */
+class splitmix64 {
+public:
+    using result_type = std::uint64_t;
+
+    explicit splitmix64(std::uint64_t seed) : state(seed) {}
+    splitmix64(std::uint64_t seed, std::uint64_t stream) : state(mix(seed) ^ mix(stream + 0x632be59bd9b4e019ULL)) {}   // stream of e.g. one tree
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        return mix(state += 0x9e3779b97f4a7c15ULL);
+    }
+
+    // finalizer of splitmix64, also used to hash keys into seeds
+    static std::uint64_t mix(std::uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    std::uint64_t state;
+};
+
+// procedures drawing random numbers, part of the key of every philox4x32 stream so the streams of two procedures never overlap
+enum class random_purpose : std::uint32_t {
+    tree_placement,
+    seed_dispersal,
+    seed_rain,
+    demography
+};
+
+/**
+ * @brief The philox4x32 class
+ * Counter-based random number engine (Philox4x32-10, Salmon et al. 2011): every block of four numbers is a keyed hash
+ * of its counter, so a stream has no state besides its position.
+ * A stream is identified by the run seed (the key) and the procedure, year and patch or tree id (the counter),
+ * any patch or tree can be processed on any thread in any order and still draws the same numbers.
+ * Usable with the standard library distributions.
+ */
+class philox4x32 {
+public:
+    using result_type = std::uint32_t;
+    using block = std::array<std::uint32_t, 4>;
+
+    philox4x32(std::uint64_t run_seed, random_purpose purpose, std::uint32_t year, std::uint64_t id)
+        : key{static_cast<std::uint32_t>(run_seed), static_cast<std::uint32_t>(run_seed >> 32)},
+          counter{0, year, static_cast<std::uint32_t>(id), static_cast<std::uint32_t>(id >> 32) ^ (static_cast<std::uint32_t>(purpose) << 24)} {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        if (position == 4) {
+            output = generate(counter, key);
+            counter[0]++;                   // next block of the stream, 2^32 blocks per stream
+            position = 0;
+        }
+        return output[position++];
+    }
+
+    std::uint64_t next_64() {           // e.g. the seed of a splitmix64 stream
+        std::uint64_t high = (*this)();
+        return (high << 32) | (*this)();
+    }
+
+    // 10 rounds of the Philox S-box and key schedule on one counter
+    static block generate(block c, std::array<std::uint32_t, 2> k) {
+        for (int round = 0; round < 10; round++) {
+            const std::uint64_t product_0 = std::uint64_t(0xD2511F53u) * c[0];
+            const std::uint64_t product_1 = std::uint64_t(0xCD9E8D57u) * c[2];
+            c = {static_cast<std::uint32_t>(product_1 >> 32) ^ c[1] ^ k[0], static_cast<std::uint32_t>(product_1),
+                 static_cast<std::uint32_t>(product_0 >> 32) ^ c[3] ^ k[1], static_cast<std::uint32_t>(product_0)};
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+        return c;
+    }
+
+private:
+    std::array<std::uint32_t, 2> key;
+    block counter;                      // block index, year, id and procedure
+    block output = {0, 0, 0, 0};
+    int position = 4;                   // next number of the output block, 4 generates the next block
+};
+
+#endif // SIM_RANDOM_H
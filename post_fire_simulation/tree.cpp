@@ -6,9 +6,11 @@
 #include <QImage>
 #include <QColor>
 
-// colors for mapping
-QRgb color_birch =  qRgb(255, 0, 0); // red
-QRgb color_oak =    qRgb(0, 0, 255); // bluer
+// colors for mapping, same order as model_species
+const QRgb species_colors[N_species] = {
+    qRgb(255, 0, 0),    // birch red
+    qRgb(0, 0, 255)     // oak bluer
+};
 
 // default constructor
 tree::tree()
@@ -33,18 +35,16 @@ tree::tree(int id,
 
 /**
  * @brief tree::update_species_params
- * Function to update the tree object's parameters according to the assigned species
+ * Function to update the tree object's parameters according to the assigned species, see model_species in population_traits.h
  */
 void tree::update_species_params() {
-    if (species == 'b') {
-        dispersal_factor = 20;
-        max_seed_production = 50;
-        color = color_birch;
-    } else if (species == 'o') {
-        dispersal_factor = 40;
-        max_seed_production = 100;
-        color = color_oak;
+    const int s = species_index(species);
+    if (s < 0) {
+        return;
     }
+    dispersal_factor = model_species[s].dispersal_factor;
+    max_seed_production = model_species[s].max_seed_production;
+    color = species_colors[s];
 }
 
 /**
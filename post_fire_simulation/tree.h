@@ -1,6 +1,7 @@
 #ifndef TREE_H
 #define TREE_H
 
+#include "population_traits.h"
 #include <vector>        // package to use vectors
 #include <QImage>
 
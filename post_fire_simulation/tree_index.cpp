@@ -0,0 +1,179 @@
+/**
+ * TREE INDEX
+ */
+
+#include "tree_index.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief tree_index::build
+ * counting sort of the trees by cell, trees in the same cell keep their order in the tree vector
+ * @param trees all trees, the queries return positions in this vector
+ * @param cell_size edge length of a cell in patches, a few trees per cell keeps the queries short
+ */
+void tree_index::build(const std::vector<tree>& trees, int x_size, int y_size, int cell_size) {
+    this->x_size = x_size;
+    this->y_size = y_size;
+    this->cell_size = std::max(cell_size, 1);
+    N_cells_x = (x_size + this->cell_size - 1) / this->cell_size;
+    N_cells_y = (y_size + this->cell_size - 1) / this->cell_size;
+
+    const int N_cells = N_cells_x * N_cells_y;
+    std::vector<int> cell_of_tree(trees.size());
+    cell_start.assign(N_cells + 1, 0);
+    for (size_t i = 0; i < trees.size(); i++) {
+        const int cx = std::min(std::max(trees[i].x_y_cor[0], 0), x_size - 1) / this->cell_size;
+        const int cy = std::min(std::max(trees[i].x_y_cor[1], 0), y_size - 1) / this->cell_size;
+        cell_of_tree[i] = cx * N_cells_y + cy;
+        cell_start[cell_of_tree[i] + 1]++;
+    }
+    for (int c = 0; c < N_cells; c++) {
+        cell_start[c + 1] += cell_start[c];
+    }
+
+    tree_ids.resize(trees.size());
+    x_cor.resize(trees.size());
+    y_cor.resize(trees.size());
+    std::vector<int> next(cell_start.begin(), cell_start.end() - 1);
+    for (size_t i = 0; i < trees.size(); i++) {
+        const int slot = next[cell_of_tree[i]]++;
+        tree_ids[slot] = static_cast<int>(i);
+        x_cor[slot] = trees[i].x_y_cor[0];
+        y_cor[slot] = trees[i].x_y_cor[1];
+    }
+}
+
+int tree_index::size() const {
+    return static_cast<int>(tree_ids.size());
+}
+
+long long tree_index::squared_distance(int i, int x, int y) const {
+    const long long dx = x_cor[i] - x;
+    const long long dy = y_cor[i] - y;
+    return dx * dx + dy * dy;
+}
+
+/**
+ * @brief tree_index::nearest
+ * searches rings of cells around the cell of (x, y): every tree in ring r or further out is at least
+ * (r - 1) * cell_size + 1 patches away, so the search stops as soon as the best tree is closer than that
+ * - ties are broken by the position in the tree vector, so the result does not depend on the cell size
+ */
+int tree_index::nearest(int x, int y) const {
+    if (tree_ids.empty()) {
+        return -1;
+    }
+    const int cx = std::min(std::max(x, 0), x_size - 1) / cell_size;
+    const int cy = std::min(std::max(y, 0), y_size - 1) / cell_size;
+    const int max_ring = std::max(std::max(cx, N_cells_x - 1 - cx), std::max(cy, N_cells_y - 1 - cy));
+
+    int best = -1;
+    long long best_distance = 0;
+    for (int ring = 0; ring <= max_ring; ring++) {
+        const long long bound = static_cast<long long>(ring - 1) * cell_size + 1;
+        if (best >= 0 && best_distance < bound * bound) {
+            break;
+        }
+        for (int i = std::max(cx - ring, 0); i <= std::min(cx + ring, N_cells_x - 1); i++) {
+            const bool edge_column = i == cx - ring || i == cx + ring;
+            const int step = edge_column ? 1 : 2 * ring;               // inner columns only have their top and bottom cell in the ring
+            for (int j = cy - ring; j <= cy + ring; j += std::max(step, 1)) {
+                if (j < 0 || j >= N_cells_y) {
+                    continue;
+                }
+                const int cell = i * N_cells_y + j;
+                for (int k = cell_start[cell]; k < cell_start[cell + 1]; k++) {
+                    const long long distance = squared_distance(k, x, y);
+                    if (best < 0 || distance < best_distance || (distance == best_distance && tree_ids[k] < best)) {
+                        best = tree_ids[k];
+                        best_distance = distance;
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief tree_index::k_nearest
+ * same ring search as nearest(), keeping the k best candidates ordered by distance and tree position
+ */
+std::vector<int> tree_index::k_nearest(int x, int y, int k) const {
+    std::vector<std::pair<long long, int>> candidates;
+    if (k <= 0 || tree_ids.empty()) {
+        return {};
+    }
+    const int cx = std::min(std::max(x, 0), x_size - 1) / cell_size;
+    const int cy = std::min(std::max(y, 0), y_size - 1) / cell_size;
+    const int max_ring = std::max(std::max(cx, N_cells_x - 1 - cx), std::max(cy, N_cells_y - 1 - cy));
+
+    for (int ring = 0; ring <= max_ring; ring++) {
+        const long long bound = static_cast<long long>(ring - 1) * cell_size + 1;
+        if (static_cast<int>(candidates.size()) >= k && candidates[k - 1].first < bound * bound) {
+            break;
+        }
+        for (int i = std::max(cx - ring, 0); i <= std::min(cx + ring, N_cells_x - 1); i++) {
+            const bool edge_column = i == cx - ring || i == cx + ring;
+            const int step = edge_column ? 1 : 2 * ring;
+            for (int j = cy - ring; j <= cy + ring; j += std::max(step, 1)) {
+                if (j < 0 || j >= N_cells_y) {
+                    continue;
+                }
+                const int cell = i * N_cells_y + j;
+                for (int c = cell_start[cell]; c < cell_start[cell + 1]; c++) {
+                    candidates.emplace_back(squared_distance(c, x, y), tree_ids[c]);
+                }
+            }
+        }
+        // only the k best candidates are needed for the stopping rule and the result
+        if (static_cast<int>(candidates.size()) > k) {
+            std::nth_element(candidates.begin(), candidates.begin() + k - 1, candidates.end());
+            candidates.resize(k);
+        }
+        std::sort(candidates.begin(), candidates.end());
+    }
+
+    std::vector<int> result;
+    result.reserve(candidates.size());
+    for (auto& candidate : candidates) {
+        result.push_back(candidate.second);
+    }
+    return result;
+}
+
+/**
+ * @brief tree_index::within_radius
+ * visits the cells overlapping the bounding square of the circle, same test as the
+ * (i - x)^2 + (j - y)^2 <= radius^2 circle of setup_burnt_area()
+ */
+std::vector<int> tree_index::within_radius(int x, int y, float radius) const {
+    std::vector<int> result;
+    if (tree_ids.empty() || radius < 0) {
+        return result;
+    }
+    const int reach = static_cast<int>(std::ceil(radius));
+    if (x + reach < 0 || y + reach < 0 || x - reach >= x_size || y - reach >= y_size) {
+        return result;
+    }
+    const int cx_min = std::max(x - reach, 0) / cell_size;
+    const int cx_max = std::min(x + reach, x_size - 1) / cell_size;
+    const int cy_min = std::max(y - reach, 0) / cell_size;
+    const int cy_max = std::min(y + reach, y_size - 1) / cell_size;
+    const double squared_radius = static_cast<double>(radius) * radius;
+    for (int i = cx_min; i <= cx_max; i++) {
+        for (int j = cy_min; j <= cy_max; j++) {
+            const int cell = i * N_cells_y + j;
+            for (int k = cell_start[cell]; k < cell_start[cell + 1]; k++) {
+                if (squared_distance(k, x, y) <= squared_radius) {
+                    result.push_back(tree_ids[k]);
+                }
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
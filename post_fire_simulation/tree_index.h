@@ -0,0 +1,37 @@
+#ifndef TREE_INDEX_H
+#define TREE_INDEX_H
+
+#include "tree.h"
+#include <vector>
+
+/**
+ * @brief The tree_index class
+ * Uniform bucket grid over the tree positions for neighbourhood queries without scanning all trees.
+ * The trees are counting-sorted by cell of cell_size * cell_size patches, a query only visits the cells
+ * overlapping its search area. Queries return positions in the tree vector the index was built from,
+ * so the index must be rebuilt whenever trees are added or removed.
+ */
+class tree_index {
+public:
+    // Member functions
+    void build(const std::vector<tree>& trees, int x_size, int y_size, int cell_size = 8);
+    int nearest(int x, int y) const;                                    // closest tree to patch (x, y), -1 if there are no trees
+    std::vector<int> k_nearest(int x, int y, int k) const;              // k closest trees, closest first
+    std::vector<int> within_radius(int x, int y, float radius) const;  // trees at most radius patches away, in tree order
+    int size() const;
+
+private:
+    long long squared_distance(int i, int x, int y) const;             // squared distance of the i-th sorted tree to (x, y)
+
+    int x_size = 0;
+    int y_size = 0;
+    int cell_size = 1;
+    int N_cells_x = 0;
+    int N_cells_y = 0;
+    std::vector<int> cell_start;        // sorted trees of cell c are cell_start[c] .. cell_start[c + 1] - 1
+    std::vector<int> tree_ids;          // position in the tree vector of each sorted tree
+    std::vector<int> x_cor;             // coordinates of each sorted tree, kept next to each other for the queries
+    std::vector<int> y_cor;
+};
+
+#endif // TREE_INDEX_H
@@ -0,0 +1,146 @@
+/**
+ * YEAR STEP
+ */
+
+#include "year_step.h"
+#include "population_kernels.h"
+#include "sim_random.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+void population_totals::add(const population_store& populations, size_t i, bool patch_burnt) {
+    for (int s = 0; s < N_stages; s++) {
+        for (int j = 0; j < N_species; j++) {
+            const int N = populations.counts(s, j)[i];
+            all[j][s] += N;
+            if (patch_burnt) {
+                burnt[j][s] += N;
+            }
+        }
+    }
+}
+
+void population_totals::add(const population_totals& other) {
+    for (int j = 0; j < N_species; j++) {
+        for (int s = 0; s < N_stages; s++) {
+            all[j][s] += other.all[j][s];
+            burnt[j][s] += other.burnt[j][s];
+        }
+    }
+}
+
+population_totals count_totals(const patch_grid& patches) {
+    population_totals totals;
+    const population_store& populations = patches.get_populations();
+    patches.for_each_occupied([&](size_t i) {
+        totals.add(populations, i, patches[i].burnt);
+    });
+    return totals;
+}
+
+/**
+ * @brief fused_tiles
+ * one year of every occupied patch and every patch set in incoming(block), tile by tile across the threads of the pool:
+ * - arrive(i, N_seeds) gives the seeds landing on patch i, which are added to its seeds
+ * - then the demography of the patch from its own stream, the same as in advance_populations_parallel()
+ *   and advance_cohorts_parallel()
+ * - then its counts are added to the local totals of the thread, which are summed at the end
+ * Tiles are whole blocks of the occupancy bitmap, so each thread only marks its own patches occupied or empty.
+ */
+template <typename Incoming, typename Arrive>
+static population_totals fused_tiles(patch_grid& patches, const transition_factors& factors, demography_mode mode,
+                                     std::uint64_t run_seed, int year, thread_pool& pool, int tile_blocks,
+                                     Incoming incoming, Arrive arrive) {
+    population_store& populations = patches.get_populations();
+    int* N[N_stages][N_species];
+    stage_arrays(populations, N);
+    const size_t tile_size = std::max(tile_blocks, 1);
+    const size_t N_tiles = (patches.N_blocks() + tile_size - 1) / tile_size;
+    std::atomic<size_t> next_tile(0);
+    std::vector<population_totals> thread_totals(pool.size());
+    pool.run([&](int thread) {
+        population_totals totals;                   // on the stack of the thread, stored once so threads never share its cache lines
+        for (size_t tile = next_tile++; tile < N_tiles; tile = next_tile++) {
+            const size_t first_block = tile * tile_size;
+            const size_t end_block = std::min(first_block + tile_size, patches.N_blocks());
+            patches.for_each_occupied_or(first_block, end_block, incoming, [&](size_t i) {
+                int N_seeds[N_species];
+                if (arrive(i, N_seeds)) {
+                    for (int j = 0; j < N_species; j++) {
+                        N[stage_seeds][j][i] += N_seeds[j];
+                    }
+                }
+                philox4x32 patch_gen(run_seed, random_purpose::demography, year, i);
+                if (mode == demography_mode::binomial_cohorts) {
+                    advance_patch_cohorts(N, i, factors.of_patch(i), patch_gen);
+                } else {
+                    advance_patch_individuals(N, i, factors.of_patch(i), patch_gen);
+                }
+                if (populations.is_empty(i)) {
+                    patches.mark_empty(i);
+                } else {
+                    patches.mark_occupied(i);
+                    totals.add(populations, i, patches[i].burnt);
+                }
+            });
+        }
+        thread_totals[thread] = totals;
+    });
+    population_totals totals;
+    for (const population_totals& t : thread_totals) {
+        totals.add(t);
+    }
+    return totals;
+}
+
+/**
+ * @brief advance_year_fused
+ * same result as deposit_seeds(), the demography of the selected mode and count_totals() one after the other,
+ * the raster is read block by block right before the demography of the block
+ * - the expected values demography is a matrix step over the whole map and is not fused
+ */
+population_totals advance_year_fused(patch_grid& patches, const seed_count_raster& arrivals, const transition_factors& factors,
+                                     demography_mode mode, std::uint64_t run_seed, int year, thread_pool& pool, int tile_blocks) {
+    const size_t N_patches = patches.size();
+    auto incoming = [&](size_t block) {
+        std::uint64_t bits = 0;
+        const size_t first = block * 64;
+        const size_t end = std::min(first + 64, N_patches);
+        for (size_t i = first; i < end; i++) {
+            for (int j = 0; j < N_species; j++) {
+                if (arrivals.counts[j][i] > 0) {
+                    bits |= std::uint64_t(1) << (i - first);
+                    break;
+                }
+            }
+        }
+        return bits;
+    };
+    auto arrive = [&](size_t i, int N_seeds[N_species]) {
+        for (int j = 0; j < N_species; j++) {
+            N_seeds[j] = std::max(arrivals.counts[j][i], 0);
+        }
+        return true;
+    };
+    return fused_tiles(patches, factors, mode, run_seed, year, pool, tile_blocks, incoming, arrive);
+}
+
+/**
+ * @brief advance_year_fused
+ * same result as seed_rain_field::draw_seeds(), the demography of the selected mode and count_totals() one after the other
+ */
+population_totals advance_year_fused(patch_grid& patches, const seed_rain_field& seed_rain, const transition_factors& factors,
+                                     demography_mode mode, std::uint64_t run_seed, int year, thread_pool& pool, int tile_blocks) {
+    auto incoming = [&](size_t block) {
+        return seed_rain.source_block(block);
+    };
+    auto arrive = [&](size_t i, int N_seeds[N_species]) {
+        if (((seed_rain.source_block(i / 64) >> (i % 64)) & 1) == 0) {
+            return false;                       // no seed rain on this patch, no draws
+        }
+        seed_rain.draw_patch_seeds(i, run_seed, year, N_seeds);
+        return true;
+    };
+    return fused_tiles(patches, factors, mode, run_seed, year, pool, tile_blocks, incoming, arrive);
+}
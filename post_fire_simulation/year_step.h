@@ -0,0 +1,50 @@
+#ifndef YEAR_STEP_H
+#define YEAR_STEP_H
+
+#include "dispersal.h"
+#include "parallel.h"
+#include "patch_grid.h"
+#include "population_dynamics.h"
+#include "seed_rain_field.h"
+#include <array>
+#include <cstdint>
+
+/**
+ * One simulated year as a single pass over the patches: the seeds arriving at a patch are added,
+ * its demography is drawn and its counts are summed while its data is in the cache, instead of the
+ * three sweeps of MainWindow::perform_dispersal(), perform_pop_dynamics() and count_populations().
+ * Every patch draws from the same streams as in the separate procedures, so both give the same result.
+ */
+
+// yearly procedures selectable in the ui, same order as the items of year_step_comboBox
+enum class year_step_mode {
+    separate_passes,    // dispersal, demography and counting one after the other over the whole map
+    fused_pass          // all three per patch in one pass over tiles of the map, see advance_year_fused()
+};
+
+// seeds and saplings per species and stage, on the whole map and on the burnt patches
+struct population_totals {
+    std::array<int, N_stages> all[N_species] = {};
+    std::array<int, N_stages> burnt[N_species] = {};
+
+    void add(const population_store& populations, size_t i, bool patch_burnt);     // counts of patch i
+    void add(const population_totals& other);
+};
+
+// totals of the occupied patches after the year, as counted by MainWindow::count_populations()
+population_totals count_totals(const patch_grid& patches);
+
+// fused year with the seeds of the exact per-seed dispersal, scattered into the raster beforehand by scatter_seeds_tiled()
+population_totals advance_year_fused(patch_grid& patches,
+                                     const seed_count_raster& arrivals,     // seeds landed this year per patch and species
+                                     const transition_factors& factors,     // up to date factors of the patches
+                                     demography_mode mode,                  // per individual or binomial cohorts
+                                     std::uint64_t run_seed, int year,
+                                     thread_pool& pool, int tile_blocks = 8);
+
+// fused year with Poisson seed arrivals from the expected seed rain, drawn as by seed_rain_field::draw_seeds()
+population_totals advance_year_fused(patch_grid& patches, const seed_rain_field& seed_rain, const transition_factors& factors,
+                                     demography_mode mode, std::uint64_t run_seed, int year,
+                                     thread_pool& pool, int tile_blocks = 8);
+
+#endif // YEAR_STEP_H
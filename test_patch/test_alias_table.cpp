@@ -0,0 +1,78 @@
+// test alias_table.cpp
+#include "catch.hpp"
+#include "../post_fire_simulation/alias_table.h"
+#include "../post_fire_simulation/seed_trajectory.h"
+#include "../post_fire_simulation/sim_random.h"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+TEST_CASE("Test alias table draws outcomes with their probabilities") {
+    // skewed weights with a zero and a tiny outcome, as in the tail of a dispersal kernel
+    std::vector<double> weights = {5, 0, 1, 20, 0.01, 3, 3, 7.99};
+    alias_table table(weights);
+    REQUIRE(table.size() == 8);
+    REQUIRE(table.get_probability(3) == Approx(0.5));
+
+    const int N_draws = 2000000;
+    std::vector<int> counts(weights.size(), 0);
+    splitmix64 gen(17);
+    for (int i = 0; i < N_draws; i++) {
+        counts[table.sample(gen())]++;
+    }
+    REQUIRE(counts[1] == 0);
+    for (size_t k = 0; k < weights.size(); k++) {
+        double expected = table.get_probability(k) * N_draws;
+        REQUIRE(std::abs(counts[k] - expected) < 5 * std::sqrt(expected) + 1);
+    }
+}
+
+TEST_CASE("Test alias table leaves a uniform position within the outcome") {
+    alias_table table(std::vector<double>{1, 2, 3, 4});
+    const int N_draws = 400000;
+    const int N_bins = 10;
+    std::vector<int> histogram(N_bins, 0);
+    splitmix64 gen(19);
+    for (int i = 0; i < N_draws; i++) {
+        float position;
+        table.sample(gen(), position);
+        REQUIRE(position >= 0.0f);
+        REQUIRE(position <= 1.0f);
+        histogram[std::min(N_bins - 1, static_cast<int>(position * N_bins))]++;
+    }
+    for (int count : histogram) {
+        REQUIRE(std::abs(count - N_draws / N_bins) < 5 * std::sqrt(N_draws / N_bins));
+    }
+}
+
+TEST_CASE("Test alias table with a single outcome") {
+    alias_table table(std::vector<double>{2.5});
+    REQUIRE(table.sample(std::uint64_t(0)) == 0);
+    REQUIRE(table.sample(~std::uint64_t(0)) == 0);
+}
+
+TEST_CASE("Test alias table draws a rare tail bin at its true rate") {
+    // 12000 bins as for a long-distance range of 3000 patches, the tail bin has a threshold of about 0.012,
+    // which the lower 32 bits resolve to 2^-32
+    std::vector<double> weights(12000, 1.0);
+    weights[11999] = 1e-6 * 11999 / (1 - 1e-6);
+    alias_table table(weights);
+    REQUIRE(table.get_probability(11999) == Approx(1e-6));
+
+    // the column comes from the upper bits, the side of the threshold from the lower bits
+    const std::uint64_t tail_column = (std::uint64_t(11999) << 32) / 12000 + 1;
+    REQUIRE(table.sample(tail_column << 32) == 11999);
+    const std::uint64_t below_threshold = static_cast<std::uint64_t>(1e-6 * 12000 * 4294967296.0) - 64;
+    const std::uint64_t above_threshold = below_threshold + 128;
+    REQUIRE(table.sample(tail_column << 32 | below_threshold) == 11999);
+    REQUIRE(table.sample(tail_column << 32 | above_threshold) != 11999);
+
+    const long long N_draws = 100000000;
+    long long N_tail = 0;
+    splitmix64 gen(29);
+    for (long long i = 0; i < N_draws; i++) {
+        N_tail += table.sample(gen()) == 11999;
+    }
+    const double expected = 1e-6 * N_draws;
+    REQUIRE(std::abs(N_tail - expected) < 5 * std::sqrt(expected));
+}
@@ -0,0 +1,178 @@
+// test analysis_pipeline.cpp against counting the populations after every year
+#include "catch.hpp"
+#include "../post_fire_simulation/analysis_pipeline.h"
+#include "../post_fire_simulation/year_step.h"
+#include "test_trees.h"
+#include <future>
+#include <utility>
+#include <vector>
+#include <random>
+
+// patches with random populations and environments like after MainWindow::setup_min_distance_to_tree()
+static patch_grid make_pipeline_grid(int x_size, int y_size, std::mt19937& gen) {
+    patch_grid patches(x_size, y_size);
+    std::uniform_int_distribution<int> rand_count(0, 12);
+    std::uniform_real_distribution<float> rand_float_01(0.0f, 1.0f);
+    for (auto& p : patches) {
+        if (rand_float_01(gen) < 0.3f) {
+            p.N_seeds = {rand_count(gen), rand_count(gen)};
+            p.N_height_class_2 = {rand_count(gen) / 3, 0};
+        }
+        p.light_availability = rand_float_01(gen);
+        p.burnt = p.x_y_cor[0] < x_size / 2;
+    }
+    patches.update_occupancy();
+    return patches;
+}
+
+static bool same_totals(const population_totals& a, const population_totals& b) {
+    for (int j = 0; j < N_species; j++) {
+        if (a.all[j] != b.all[j] || a.burnt[j] != b.burnt[j]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Test copying the state of a grid") {
+    std::mt19937 gen(2);
+    patch_grid source = make_pipeline_grid(20, 15, gen);
+    patch_grid copy(20, 15);
+    copy.at(3, 3).light_availability = 0.25f;
+    copy.copy_state(source);
+    for (int j = 0; j < N_species; j++) {
+        REQUIRE(count_totals(copy).all[j] == count_totals(source).all[j]);
+        REQUIRE(count_totals(copy).burnt[j][stage_seeds] == 0);         // burnt patches of the own environment
+    }
+    REQUIRE(copy.N_occupied() == source.N_occupied());
+    REQUIRE(copy.at(3, 3).light_availability == 0.25f);        // the environment is kept
+    REQUIRE(copy.at(0, 0).burnt == false);
+    copy.at(4, 4).N_seeds[0] = 99;                             // the patches still view the own store
+    REQUIRE(copy.get_populations().counts(stage_seeds, 0)[copy.index(4, 4)] == 99);
+    REQUIRE(source.at(4, 4).N_seeds[0] != 99);
+}
+
+TEST_CASE("Test pipelined counts equal counting after every year") {
+    std::mt19937 gen(8);
+    patch_grid patches = make_pipeline_grid(60, 50, gen);
+    patch_grid serial = patches;
+    transition_factors factors;
+    factors.update(patches);
+    thread_pool pool(2);
+
+    std::vector<std::pair<int, population_totals>> pipelined;
+    std::vector<population_totals> expected;
+    {
+        analysis_pipeline analysis([&](const patch_grid& snapshot, int year) {
+            pipelined.emplace_back(year, count_totals(snapshot));
+        });
+        for (int year = 0; year < 6; year++) {
+            advance_cohorts_parallel(patches, factors, 5, year, pool);
+            analysis.submit(patches, year);
+            advance_cohorts(serial, factors, 5, year);
+            expected.push_back(count_totals(serial));
+        }
+        analysis.wait();
+        REQUIRE(pipelined.size() == expected.size());
+        analysis.submit(patches, 6);                            // the destructor waits for this one
+    }
+    REQUIRE(pipelined.size() == 7);
+    for (size_t year = 0; year < expected.size(); year++) {
+        REQUIRE(pipelined[year].first == static_cast<int>(year));
+        REQUIRE(same_totals(pipelined[year].second, expected[year]));
+        REQUIRE(pipelined[year].second.burnt[0][stage_seeds] > 0);
+    }
+}
+
+TEST_CASE("Test the snapshot does not change while the next year is simulated") {
+    std::mt19937 gen(13);
+    patch_grid patches = make_pipeline_grid(40, 40, gen);
+    transition_factors factors;
+    factors.update(patches);
+    std::promise<void> next_year_done;
+    std::future<void> next_year = next_year_done.get_future();
+
+    population_totals before;
+    population_totals after;
+    analysis_pipeline analysis([&](const patch_grid& snapshot, int) {
+        before = count_totals(snapshot);
+        next_year.wait();                                       // the live patches have advanced meanwhile
+        after = count_totals(snapshot);
+    });
+    const population_totals year_0 = count_totals(patches);
+    analysis.submit(patches, 0);
+    advance_cohorts(patches, factors, 3, 1);
+    next_year_done.set_value();
+    analysis.wait();
+    REQUIRE(same_totals(before, year_0));
+    REQUIRE(same_totals(after, year_0));
+    REQUIRE_FALSE(same_totals(count_totals(patches), year_0));
+}
+
+TEST_CASE("Test a new setup of the same extent is counted with its own burnt area") {
+    std::mt19937 gen(21);
+    patch_grid first_setup = make_pipeline_grid(30, 20, gen);
+    patch_grid second_setup = make_pipeline_grid(30, 20, gen);
+    for (auto& p : second_setup) {
+        p.burnt = p.x_y_cor[0] >= 20;                           // another fire footprint on a map of the same size
+    }
+    REQUIRE_FALSE(same_totals(count_totals(first_setup), count_totals(second_setup)));
+
+    std::vector<population_totals> counted;
+    analysis_pipeline analysis([&](const patch_grid& snapshot, int) {
+        counted.push_back(count_totals(snapshot));
+    });
+    analysis.submit(first_setup, 0);
+    analysis.submit(first_setup, 1);
+    analysis.reset();                                           // as MainWindow::setup_map()
+    analysis.submit(second_setup, 0);
+    analysis.submit(second_setup, 1);
+    analysis.wait();
+    REQUIRE(counted.size() == 4);
+    REQUIRE(same_totals(counted[1], count_totals(first_setup)));
+    REQUIRE(same_totals(counted[2], count_totals(second_setup)));
+    REQUIRE(same_totals(counted[3], count_totals(second_setup)));
+    REQUIRE(counted[3].burnt[0][stage_seeds] > 0);
+}
+
+TEST_CASE("Benchmark pipelined analysis against counting after every year", "[.][benchmark]") {
+    std::mt19937 gen(4);
+    patch_grid start = make_pipeline_grid(300, 300, gen);
+    std::vector<tree> trees = make_random_trees(900, 300, 300, 0.5f, gen);
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+    seed_rain_field seed_rain;
+    seed_rain.build(trees, stencils, 300, 300);
+    transition_factors factors;
+    factors.update(start);
+    thread_pool pool;
+
+    BENCHMARK_ADVANCED("counting after every year, 10 years")(Catch::Benchmark::Chronometer meter) {
+        patch_grid patches = start;
+        meter.measure([&] {
+            long long total = 0;
+            for (int year = 0; year < 10; year++) {
+                seed_rain.draw_seeds(patches, 1, year);
+                advance_cohorts_parallel(patches, factors, 1, year, pool);
+                total += count_totals(patches).all[0][stage_seeds];
+            }
+            return total;
+        });
+    };
+    BENCHMARK_ADVANCED("pipelined counting, 10 years")(Catch::Benchmark::Chronometer meter) {
+        patch_grid patches = start;
+        meter.measure([&] {
+            long long total = 0;
+            analysis_pipeline analysis([&](const patch_grid& snapshot, int) {
+                total += count_totals(snapshot).all[0][stage_seeds];
+            });
+            for (int year = 0; year < 10; year++) {
+                seed_rain.draw_seeds(patches, 1, year);
+                advance_cohorts_parallel(patches, factors, 1, year, pool);
+                analysis.submit(patches, year);
+            }
+            analysis.wait();
+            return total;
+        });
+    };
+}
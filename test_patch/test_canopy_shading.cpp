@@ -0,0 +1,78 @@
+// test canopy_shading.cpp against summing the shading kernel of every tree on every patch
+#include "catch.hpp"
+#include "../post_fire_simulation/canopy_shading.h"
+#include "test_trees.h"
+#include <cstdlib>
+#include <vector>
+#include <random>
+
+// shading of every patch as the sum over all trees of the separable kernel weights
+static std::vector<float> brute_force_shading(const std::vector<tree>& trees, int x_size, int y_size, int box_radius) {
+    std::vector<long long> weights = shading_kernel_weights(box_radius);
+    const int reach = 3 * box_radius;
+    const long long peak = weights[reach];
+    std::vector<float> shading(x_size * y_size);
+    for (int x = 0; x < x_size; x++) {
+        for (int y = 0; y < y_size; y++) {
+            long long sum = 0;
+            for (auto& t : trees) {
+                int dx = t.x_y_cor[0] - x;
+                int dy = t.x_y_cor[1] - y;
+                if (std::abs(dx) <= reach && std::abs(dy) <= reach) {
+                    sum += weights[dx + reach] * weights[dy + reach];
+                }
+            }
+            shading[x * y_size + y] = static_cast<float>(sum * (1.0 / static_cast<double>(peak * peak)));
+        }
+    }
+    return shading;
+}
+
+TEST_CASE("Test shading kernel weights are three iterated boxes") {
+    REQUIRE(shading_kernel_weights(0) == std::vector<long long>{1});
+    REQUIRE(shading_kernel_weights(1) == std::vector<long long>{1, 3, 6, 7, 6, 3, 1});
+    std::vector<long long> weights = shading_kernel_weights(2);
+    REQUIRE(weights.size() == 13);
+    REQUIRE(weights[6] == 19);                                  // 3 * r^2 + 3 * r + 1
+    long long sum = 0;
+    for (long long w : weights) {
+        sum += w;
+    }
+    REQUIRE(sum == 5 * 5 * 5);
+}
+
+TEST_CASE("Test canopy shading equals summing the kernel of every tree") {
+    std::mt19937 gen(29);
+    for (int box_radius : {1, 2, 4}) {
+        for (int N_trees : {0, 1, 30, 500}) {
+            std::vector<tree> trees = make_random_trees(N_trees, 60, 45, 0.5f, gen);
+            trees.push_back(make_tree(N_trees, 0, 44, 'o'));    // trees on the map edges
+            trees.push_back(make_tree(N_trees + 1, 59, 0, 'b'));
+            trees.push_back(make_tree(N_trees + 2, 59, 0, 'b'));    // two trees on the same patch
+            REQUIRE(canopy_shading(trees, 60, 45, box_radius) == brute_force_shading(trees, 60, 45, box_radius));
+        }
+    }
+}
+
+TEST_CASE("Test canopy shading of a single tree") {
+    std::vector<tree> trees = {make_tree(0, 20, 20, 'b')};
+    std::vector<float> shading = canopy_shading(trees, 41, 41, 2);
+    REQUIRE(shading[20 * 41 + 20] == 1.0f);                     // the tree shades its own patch completely
+    REQUIRE(shading[26 * 41 + 20] > 0.0f);                      // and reaches 6 patches = 30 m
+    REQUIRE(shading[27 * 41 + 20] == 0.0f);
+    REQUIRE(shading[21 * 41 + 20] < 1.0f);
+    REQUIRE(shading[21 * 41 + 20] > shading[22 * 41 + 20]);
+}
+
+TEST_CASE("Benchmark canopy shading against summing every tree", "[.][benchmark]") {
+    for (int N_trees_per_ha : {10, 100, 500}) {
+        std::mt19937 gen(1);
+        std::vector<tree> trees = make_random_trees(N_trees_per_ha * 9, 300, 300, 0.5f, gen);     // 300 x 300 patches = 9 ha
+        BENCHMARK("sum over trees, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            return brute_force_shading(trees, 300, 300, 2);
+        };
+        BENCHMARK("box filters, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            return canopy_shading(trees, 300, 300, 2);
+        };
+    }
+}
@@ -0,0 +1,267 @@
+// test dispersal_kernel.h and the kernel selection of dispersal_stencil.cpp
+#include "catch.hpp"
+#include "../post_fire_simulation/dispersal.h"
+#include "../post_fire_simulation/dispersal_kernel.h"
+#include "../post_fire_simulation/dispersal_stencil.h"
+#include "test_trees.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <random>
+
+TEMPLATE_TEST_CASE("Test kernel samplers invert the truncated distance distribution", "",
+                   exponential_kernel, student_2dt_kernel, lognormal_kernel, fat_tailed_kernel) {
+    for (int dispersal_factor : {20, 40}) {
+        TestType kernel(dispersal_factor);
+        REQUIRE(kernel.cut > 0.5f);
+        REQUIRE(kernel.cut < 1.0f);
+        float previous = 0;
+        for (int k = 0; k < 1000; k++) {
+            float u = (k + 0.5f) / 1000;
+            float distance = kernel.distance(u);
+            REQUIRE(distance >= previous);                  // inverse cdf is monotonic
+            REQUIRE(distance <= kernel.max_distance);
+            REQUIRE(kernel.cdf(distance) / kernel.cut == Approx(u).margin(1e-4));
+            previous = distance;
+        }
+    }
+}
+
+TEST_CASE("Test model kernel keeps the distance decay of the original model") {
+    model_kernel kernel(40);
+    for (int k = 0; k < 100; k++) {
+        float u = k / 100.0f;
+        float distance_decay = std::pow(2, -3 * u);
+        REQUIRE(kernel.distance(u) == 40 * distance_decay);
+        REQUIRE(kernel.cdf(kernel.distance(u)) == Approx(1 - u).margin(1e-5));     // the distance decreases with u
+    }
+    REQUIRE(dispersal_stencil(40, 100).max_distance() == 40);
+    REQUIRE(dispersal_stencil(40, 100, dispersal_kernel_type::fat_tailed).max_distance() == 80);
+}
+
+TEST_CASE("Test fat-tailed kernel keeps its power-law tail up to the long-distance range") {
+    fat_tailed_kernel kernel(40, 400);
+    REQUIRE(kernel.max_distance == 400);
+    REQUIRE(fat_tailed_kernel(40, 50).max_distance == 80);      // never shorter than the thin-tailed kernels
+    REQUIRE(exponential_kernel(40).max_distance == 80);
+
+    dispersal_stencil stencil(40, 100, dispersal_settings(dispersal_kernel_type::fat_tailed, 0, 400));
+    REQUIRE(stencil.local_max_distance() == 80);
+    REQUIRE(stencil.max_distance() == 400);
+    REQUIRE(dispersal_stencil(40, 100, dispersal_settings(dispersal_kernel_type::student_2dt, 0, 400)).max_distance() == 80);
+
+    // share of the seeds beyond twice the dispersal factor follows the untruncated power law up to the range
+    splitmix64 gen(31);
+    const int N_seeds = 400000;
+    int N_beyond = 0;
+    float longest = 0;
+    for (int i = 0; i < N_seeds; i++) {
+        float distance = stencil.distance(uniform_float(gen));
+        N_beyond += distance > 80;
+        longest = std::max(longest, distance);
+    }
+    const double expected = (1 - kernel.cdf(80) / kernel.cut) * N_seeds;
+    REQUIRE(expected > 0.02 * N_seeds);
+    REQUIRE(std::abs(N_beyond - expected) < 5 * std::sqrt(expected));
+    REQUIRE(longest > 200);
+    REQUIRE(longest <= 400);
+}
+
+TEST_CASE("Test stencil offsets follow the selected kernel") {
+    splitmix64 gen(5);
+    seed_batch batch;
+    for (dispersal_kernel_type type : {dispersal_kernel_type::exponential, dispersal_kernel_type::student_2dt,
+                                       dispersal_kernel_type::lognormal, dispersal_kernel_type::fat_tailed}) {
+        dispersal_stencil stencil(20, 50, type);
+        for (int N_seeds = 1; N_seeds <= 50; N_seeds++) {
+            batch.resize(N_seeds);
+            for (int i = 0; i < N_seeds; i++) {
+                batch.uniforms[i] = uniform_float(gen);
+            }
+            stencil.generate_offsets(batch);
+            for (int i = 0; i < N_seeds; i++) {
+                float distance = stencil.distance(batch.uniforms[i]);
+                REQUIRE(batch.offset_x[i] == static_cast<int>(distance * stencil.get_cos_directions(N_seeds)[i]));
+                REQUIRE(batch.offset_y[i] == static_cast<int>(distance * stencil.get_sin_directions(N_seeds)[i]));
+                REQUIRE(std::abs(batch.offset_x[i]) <= stencil.max_distance());
+                REQUIRE(std::abs(batch.offset_y[i]) <= stencil.max_distance());
+            }
+        }
+    }
+}
+
+TEST_CASE("Test tiled seed scatter with long-tailed kernels counts the same seeds as plain scatter") {
+    // the tails reach twice the dispersal factor, so the tile halo must grow with them
+    std::mt19937 gen(13);
+    std::vector<tree> trees = make_random_trees(600, 170, 130, 0.5f, gen);
+    dispersal_stencil_set stencils;
+    stencils.build(trees, dispersal_kernel_type::student_2dt, dispersal_kernel_type::fat_tailed);
+    REQUIRE(stencils.max_distance() == 80);
+
+    seed_count_raster plain;
+    plain.reset(170, 130);
+    scatter_seeds(trees, stencils, plain, 21);
+    for (int N_threads : {1, 4}) {
+        seed_count_raster tiled;
+        tiled.reset(170, 130);
+        thread_pool pool(N_threads);
+        scatter_seeds_tiled(trees, stencils, tiled, 21, pool, 32);
+        REQUIRE(tiled.counts[0] == plain.counts[0]);
+        REQUIRE(tiled.counts[1] == plain.counts[1]);
+    }
+}
+
+TEST_CASE("Benchmark dispersal kernels", "[.][benchmark]") {
+    std::mt19937 gen(1);
+    std::vector<tree> trees = make_random_trees(27000, 300, 300, 0.5f, gen);  // 3000 trees/ha on the default map
+    seed_count_raster raster;
+    raster.reset(300, 300);
+    thread_pool pool(1);
+    for (dispersal_kernel_type type : {dispersal_kernel_type::model, dispersal_kernel_type::exponential, dispersal_kernel_type::student_2dt,
+                                       dispersal_kernel_type::lognormal, dispersal_kernel_type::fat_tailed}) {
+        dispersal_stencil_set stencils;
+        stencils.build(trees, type, type);
+        BENCHMARK(std::string("one year of exact dispersal, ") + dispersal_kernel_name(type) + " kernel") {
+            scatter_seeds_tiled(trees, stencils, raster, 1, pool);
+        };
+    }
+}
+
+TEST_CASE("Test long-distance tail throws a share of the seeds beyond the kernel") {
+    const float share = 0.05f;
+    dispersal_stencil stencil(40, 100, dispersal_settings(dispersal_kernel_type::model, share, 500));
+    REQUIRE(stencil.local_max_distance() == 40);
+    REQUIRE(stencil.max_distance() == 500);
+
+    // share of seeds beyond the model kernel and mass of the quadrature points
+    std::vector<float> distances;
+    std::vector<double> weights;
+    stencil.distance_quadrature(distances, weights);
+    double total = 0, beyond_kernel = 0;
+    for (size_t q = 0; q < distances.size(); q++) {
+        total += weights[q];
+        if (distances[q] > 40) {
+            beyond_kernel += weights[q];
+        }
+    }
+    long_distance_kernel tail(40, 500);
+    REQUIRE(total == Approx(1.0));
+    REQUIRE(beyond_kernel == Approx(share * (1 - tail.cdf(40) / tail.cut)).epsilon(1e-3));
+
+    // the same share in the drawn offsets, all within the range
+    splitmix64 gen(23);
+    seed_batch batch;
+    int N_seeds_total = 0, N_far = 0;
+    for (int tree = 0; tree < 20000; tree++) {
+        batch.draw(100, gen);
+        stencil.generate_offsets(batch);
+        for (int i = 0; i < 100; i++) {
+            REQUIRE(std::abs(batch.offset_x[i]) <= 500);
+            REQUIRE(std::abs(batch.offset_y[i]) <= 500);
+            N_far += std::hypot(batch.offset_x[i], batch.offset_y[i]) > 41.5;  // offsets are truncated towards 0
+            N_seeds_total++;
+        }
+    }
+    double expected_far = share * (1 - tail.cdf(41.5f) / tail.cut) * N_seeds_total;
+    REQUIRE(std::abs(N_far - expected_far) < 5 * std::sqrt(expected_far));
+}
+
+TEST_CASE("Test long-distance ranges are clamped to the map diagonal") {
+    REQUIRE(map_reach(300, 300) == 425);
+    REQUIRE(map_reach(30, 40) == 50);
+    std::mt19937 gen(3);
+    std::vector<tree> trees = make_random_trees(50, 300, 300, 0.5f, gen);
+    dispersal_stencil_set stencils;
+    stencils.build(trees, dispersal_settings(dispersal_kernel_type::model, 0.1f, 3000),
+                   dispersal_settings(dispersal_kernel_type::exponential, 0.1f, 200), map_reach(300, 300));
+    REQUIRE(stencils.max_distance() == 425);
+    REQUIRE(stencils.for_species('b').long_distance_range == 425);
+    REQUIRE(stencils.for_species('o').long_distance_range == 200);     // ranges within the map are kept
+
+    std::vector<float> distances;
+    std::vector<double> weights;
+    stencils.for_species('b').distance_quadrature(distances, weights);
+    REQUIRE(distances.size() <= 4 * static_cast<size_t>(std::ceil(425 / alias_kernel::bin_width)));
+    REQUIRE(*std::max_element(distances.begin(), distances.end()) <= 425);
+}
+
+TEST_CASE("Test tiled seed scatter with long-distance tails counts the same seeds as plain scatter") {
+    // tail seeds landing beyond the tile halo go through the per-thread lists of far seeds
+    std::mt19937 gen(29);
+    std::vector<tree> trees = make_random_trees(600, 200, 150, 0.5f, gen);
+    dispersal_stencil_set stencils;
+    stencils.build(trees, dispersal_settings(dispersal_kernel_type::exponential, 0.1f, 150),
+                   dispersal_settings(dispersal_kernel_type::model, 0.2f, 300));
+    REQUIRE(stencils.local_max_distance() == 40);
+    REQUIRE(stencils.max_distance() == 300);
+
+    seed_count_raster plain;
+    plain.reset(200, 150);
+    scatter_seeds(trees, stencils, plain, 31);
+    for (int N_threads : {1, 3}) {
+        seed_count_raster tiled;
+        tiled.reset(200, 150);
+        thread_pool pool(N_threads);
+        scatter_seeds_tiled(trees, stencils, tiled, 31, pool, 32);
+        REQUIRE(tiled.counts[0] == plain.counts[0]);
+        REQUIRE(tiled.counts[1] == plain.counts[1]);
+    }
+}
+
+TEST_CASE("Benchmark long-distance tails", "[.][benchmark]") {
+    // per-seed cost of the alias table against rejection sampling of the same mixture from a uniform
+    // distance proposal, whose acceptance rate drops as the tail gets heavier and longer
+    const int N_seeds = 100000;
+    splitmix64 gen(1);
+    seed_batch batch;
+    batch.draw(100, gen);
+    // a share of 1e-9 keeps the alias table in the rows without a tail
+    for (float share : {0.0f, 0.01f, 0.1f, 0.5f}) {
+        for (int range : {100, 1000}) {
+            dispersal_stencil stencil(40, 100, dispersal_settings(dispersal_kernel_type::fat_tailed, share > 0 ? share : 1e-9f, range));
+            std::string name = std::to_string(static_cast<int>(share * 100)) + " % tail to " + std::to_string(range) + " patches, 100000 seeds";
+            BENCHMARK("alias table, " + name) {
+                for (int k = 0; k < N_seeds / 100; k++) {
+                    stencil.generate_offsets(batch);
+                }
+                return batch.offset_x[0];
+            };
+
+            // rejection sampling: propose r uniform in [0, range), accept with pdf(r) / max pdf
+            fat_tailed_kernel local(40, range);
+            long_distance_kernel tail(40, range);
+            auto pdf = [&](float r) {
+                float local_pdf = r < local.max_distance ? local.b / local.a * std::pow(1 + r / local.a, -local.b - 1) / local.cut : 0.0f;
+                float tail_pdf = tail.a / ((tail.a + r) * (tail.a + r)) / tail.cut;
+                return (1 - share) * local_pdf + share * tail_pdf;
+            };
+            const float max_pdf = pdf(0);
+            BENCHMARK("rejection sampling, " + name) {
+                float sum = 0;
+                for (int k = 0; k < N_seeds; k++) {
+                    float r;
+                    do {
+                        r = uniform_float(gen) * range;
+                    } while (uniform_float(gen) * max_pdf > pdf(r));
+                    sum += r;
+                }
+                return sum;
+            };
+        }
+    }
+
+    std::mt19937 tree_gen(1);
+    std::vector<tree> trees = make_random_trees(27000, 300, 300, 0.5f, tree_gen);  // 3000 trees/ha on the default map
+    seed_count_raster raster;
+    raster.reset(300, 300);
+    thread_pool pool(1);
+    for (float share : {0.0f, 0.01f, 0.1f, 0.5f}) {
+        dispersal_stencil_set stencils;
+        dispersal_settings settings(dispersal_kernel_type::model, share > 0 ? share : 1e-9f, 300);
+        stencils.build(trees, settings, settings);
+        BENCHMARK("one year of exact dispersal, " + std::to_string(static_cast<int>(share * 100)) + " % tail to 300 patches") {
+            scatter_seeds_tiled(trees, stencils, raster, 1, pool);
+        };
+    }
+}
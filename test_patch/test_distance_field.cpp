@@ -0,0 +1,88 @@
+// test distance_field.cpp updates against recomputing the distance transform of all trees
+#include "catch.hpp"
+#include "../post_fire_simulation/distance_field.h"
+#include "../post_fire_simulation/distance_transform.h"
+#include "test_trees.h"
+#include <algorithm>
+#include <vector>
+#include <random>
+
+static std::vector<float> field_distances(const distance_field& field) {
+    std::vector<float> distances(field.size());
+    for (int i = 0; i < field.size(); i++) {
+        distances[i] = field.distance(i);
+    }
+    return distances;
+}
+
+TEST_CASE("Test distance field after removing and adding trees equals a full recompute") {
+    std::mt19937 gen(3);
+    for (int block_size : {1, 7, 16}) {
+        std::vector<tree> trees = make_random_trees(150, 90, 70, 0.5f, gen);
+        trees.push_back(make_tree(150, 89, 0, 'b'));
+        trees.push_back(make_tree(151, 89, 0, 'b'));            // two trees on the same patch
+        distance_field field;
+        field.build(trees, 90, 70, block_size);
+        REQUIRE(field.take_changed_patches().size() == 90 * 70);
+        REQUIRE(field_distances(field) == distance_to_nearest_tree(trees, 90, 70));
+
+        std::uniform_int_distribution<int> rand_x_cor(0, 89);
+        std::uniform_int_distribution<int> rand_y_cor(0, 69);
+        for (int step = 0; step < 200; step++) {
+            std::vector<float> before = field_distances(field);
+            if (step % 3 == 2 || trees.size() < 3) {             // add a tree
+                tree t = make_tree(step, rand_x_cor(gen), rand_y_cor(gen), 'o');
+                field.add_tree(t.x_y_cor[0], t.x_y_cor[1]);
+                trees.push_back(t);
+            } else {                                            // remove a random tree
+                std::uniform_int_distribution<int> rand_tree(0, static_cast<int>(trees.size()) - 1);
+                int i = rand_tree(gen);
+                field.remove_tree(trees[i].x_y_cor[0], trees[i].x_y_cor[1]);
+                trees.erase(trees.begin() + i);
+            }
+            std::vector<float> after = field_distances(field);
+            REQUIRE(after == distance_to_nearest_tree(trees, 90, 70));
+
+            // exactly the patches with a new distance are reported
+            std::vector<int> expected_changes;
+            for (int p = 0; p < field.size(); p++) {
+                if (after[p] != before[p]) {
+                    expected_changes.push_back(p);
+                }
+            }
+            REQUIRE(field.take_changed_patches() == expected_changes);
+        }
+    }
+}
+
+TEST_CASE("Test distance field of the last tree removed and a tree added to an empty map") {
+    std::vector<tree> trees = {make_tree(0, 4, 2, 'b')};
+    distance_field field;
+    field.build(trees, 9, 6, 4);
+    field.remove_tree(4, 2);
+    for (int i = 0; i < field.size(); i++) {
+        REQUIRE(field.squared_distance(i) == -1);
+    }
+    field.add_tree(8, 5);
+    trees = {make_tree(1, 8, 5, 'o')};
+    REQUIRE(field_distances(field) == distance_to_nearest_tree(trees, 9, 6));
+}
+
+TEST_CASE("Benchmark distance field updates against a full recompute", "[.][benchmark]") {
+    for (int N_trees_per_ha : {10, 100, 500}) {
+        std::mt19937 gen(1);
+        std::vector<tree> trees = make_random_trees(N_trees_per_ha * 9, 300, 300, 0.5f, gen);     // 300 x 300 patches = 9 ha
+        distance_field field;
+        field.build(trees, 300, 300);
+        BENCHMARK("full recompute, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            return distance_to_nearest_tree(trees, 300, 300);
+        };
+        int i = 0;
+        BENCHMARK("remove and add one tree, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            const tree& t = trees[i++ % trees.size()];
+            field.remove_tree(t.x_y_cor[0], t.x_y_cor[1]);
+            field.add_tree(t.x_y_cor[0], t.x_y_cor[1]);
+            return field.take_changed_patches().size();
+        };
+    }
+}
@@ -0,0 +1,61 @@
+// test distance_transform.cpp against the brute force distances of the original setup_min_distance_to_tree()
+#include "catch.hpp"
+#include "../post_fire_simulation/distance_transform.h"
+#include "test_trees.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <random>
+
+// distance from every patch to every tree as in the original MainWindow::setup_min_distance_to_tree()
+static std::vector<float> brute_force_distances(const std::vector<tree>& trees, int x_size, int y_size) {
+    std::vector<float> min_distances(x_size * y_size);
+    for (int x = 0; x < x_size; x++) {
+        for (int y = 0; y < y_size; y++) {
+            std::vector<float> distances(trees.size(), 0.0f);
+            for (unsigned int i = 0; i < trees.size(); i++) {
+                float distance = sqrt(pow(trees[i].x_y_cor[0] - x, 2) + pow(trees[i].x_y_cor[1] - y, 2));
+                distances[i] = distance;
+            }
+            min_distances[x * y_size + y] = *std::min_element(distances.begin(), distances.end());
+        }
+    }
+    return min_distances;
+}
+
+TEST_CASE("Test distance transform equals the brute force distances to the nearest tree") {
+    std::mt19937 gen(37);
+    for (int N_trees : {1, 3, 40, 600}) {
+        std::vector<tree> trees = make_random_trees(N_trees, 90, 70, 0.5f, gen);
+        trees.push_back(make_tree(N_trees, 0, 69, 'o'));        // trees on the map edges
+        trees.push_back(make_tree(N_trees + 1, 89, 0, 'b'));
+        trees.push_back(make_tree(N_trees + 2, 89, 0, 'b'));    // two trees on the same patch
+        REQUIRE(distance_to_nearest_tree(trees, 90, 70) == brute_force_distances(trees, 90, 70));
+    }
+}
+
+TEST_CASE("Test squared distance transform of a single site and of an empty grid") {
+    std::vector<char> is_site(7 * 5, 0);
+    REQUIRE(squared_distance_transform(is_site, 7, 5) == std::vector<long long>(7 * 5, -1));
+
+    is_site[6 * 5 + 4] = 1;                                     // corner (6, 4)
+    std::vector<long long> squared_distance = squared_distance_transform(is_site, 7, 5);
+    for (int x = 0; x < 7; x++) {
+        for (int y = 0; y < 5; y++) {
+            REQUIRE(squared_distance[x * 5 + y] == (6 - x) * (6 - x) + (4 - y) * (4 - y));
+        }
+    }
+}
+
+TEST_CASE("Benchmark distance transform against brute force distances", "[.][benchmark]") {
+    for (int N_trees_per_ha : {10, 100, 500}) {
+        std::mt19937 gen(1);
+        std::vector<tree> trees = make_random_trees(N_trees_per_ha * 9, 300, 300, 0.5f, gen);     // 300 x 300 patches = 9 ha
+        BENCHMARK("brute force, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            return brute_force_distances(trees, 300, 300);
+        };
+        BENCHMARK("distance transform, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            return distance_to_nearest_tree(trees, 300, 300);
+        };
+    }
+}
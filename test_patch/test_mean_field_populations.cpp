@@ -0,0 +1,168 @@
+// test mean_field_populations.cpp against the binomial cohort draws of population_dynamics.cpp
+#include "catch.hpp"
+#include "../post_fire_simulation/mean_field_populations.h"
+#include "../post_fire_simulation/population_dynamics.h"
+#include "../post_fire_simulation/seed_rain_field.h"
+#include "test_trees.h"
+#include <cmath>
+#include <vector>
+#include <random>
+
+// patches with random populations and environments like after MainWindow::setup_min_distance_to_tree()
+static patch_grid make_random_grid(int x_size, int y_size, std::mt19937& gen) {
+    patch_grid patches(x_size, y_size);
+    std::uniform_int_distribution<int> rand_count(0, 20);
+    std::uniform_real_distribution<float> rand_float_01(0.0f, 1.0f);
+    for (auto& p : patches) {
+        for (int j = 0; j < 2; j++) {
+            p.N_seeds[j] = rand_count(gen);
+            p.N_height_class_2[j] = rand_count(gen) / 2;
+            p.N_height_class_4[j] = rand_count(gen) / 4;
+        }
+        p.light_availability = rand_float_01(gen);
+        p.water_availability = rand_float_01(gen) < 0.2f ? 0.5f : 1.0f;
+    }
+    patches.update_occupancy();
+    return patches;
+}
+
+TEST_CASE("Test one year of expected values") {
+    patch_grid patches(1, 1);
+    patches[0].N_seeds = {100, 0};
+    patches[0].N_height_class_1 = {10, 0};
+    patches[0].N_height_class_2 = {20, 0};
+    patches[0].N_height_class_3 = {30, 0};
+    patches[0].N_height_class_4 = {40, 8};
+    patches[0].light_availability = 0.5f;
+    patches[0].water_availability = 0.5f;
+    transition_factors factors;
+    factors.update(patches);
+    const double m = 0.2 * 0.5 * 0.5;       // mortality
+    const double g = 0.2 * 0.5 * 0.5;       // growth
+    const double g1 = 0.2;                  // growth of height class 1
+
+    mean_field_populations expected;
+    expected.reset(patches);
+    expected.set_transitions(factors);
+    expected.advance();
+    REQUIRE(expected.expected_count(stage_height_class_4, 0, 0) == Approx(40 * (1 - m) + 30 * (1 - m) * g));
+    REQUIRE(expected.expected_count(stage_height_class_3, 0, 0) == Approx(30 * (1 - m) * (1 - g) + 20 * (1 - m) * g));
+    REQUIRE(expected.expected_count(stage_height_class_2, 0, 0) == Approx(20 * (1 - m) * (1 - g) + 10 * (1 - m) * g1));
+    REQUIRE(expected.expected_count(stage_height_class_1, 0, 0) == Approx(10 * (1 - m) * (1 - g1) + 100 * (1 - m) * g));
+    REQUIRE(expected.expected_count(stage_seeds, 0, 0) == Approx(100 * (1 - m) * (1 - g)));
+    REQUIRE(expected.expected_count(stage_height_class_4, 1, 0) == Approx(8 * (1 - m)));
+    REQUIRE(expected.total(stage_height_class_4, 1) == Approx(8 * (1 - m)));
+
+    SECTION("Test rounded counts in the patches") {
+        expected.write_counts(patches);
+        REQUIRE(patches[0].N_seeds[0] == std::lround(100 * (1 - m) * (1 - g)));
+        REQUIRE(patches[0].N_height_class_4[1] == 8);
+        REQUIRE(patches.is_occupied(0));
+    }
+}
+
+TEST_CASE("Test expected values are the mean of the binomial cohort draws") {
+    // identical patches, so the mean over the map estimates the expected count of one patch
+    patch_grid patches(100, 100);
+    for (auto& p : patches) {
+        p.N_seeds = {30, 10};
+        p.N_height_class_2 = {6, 4};
+        p.light_availability = 0.6f;
+        p.water_availability = 0.5f;
+    }
+    patches.update_occupancy();
+    transition_factors factors;
+    factors.update(patches);
+    mean_field_populations expected;
+    expected.reset(patches);
+    expected.set_transitions(factors);
+
+    std::mt19937 gen(3);
+    for (int year = 0; year < 4; year++) {
+        advance_cohorts(patches, factors, gen);
+        expected.advance();
+    }
+    const population_store& populations = patches.get_populations();
+    for (int s = 0; s < N_stages; s++) {
+        for (int j = 0; j < N_species; j++) {
+            double total = 0;
+            for (size_t i = 0; i < patches.size(); i++) {
+                total += populations.counts(s, j)[i];
+            }
+            REQUIRE(total == Approx(expected.total(s, j)).epsilon(0.03).margin(20));
+        }
+    }
+}
+
+TEST_CASE("Test k years from matrix powers equal k single years") {
+    std::mt19937 gen(9);
+    patch_grid patches = make_random_grid(60, 45, gen);
+    std::vector<tree> trees = make_random_trees(30, 60, 45, 0.5f, gen);
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+    seed_rain_field seed_rain;
+    seed_rain.build(trees, stencils, 60, 45);
+    transition_factors factors;
+    factors.update(patches);
+
+    for (int k : {2, 5, 16, 37}) {
+        mean_field_populations yearly;
+        yearly.reset(patches);
+        yearly.set_seed_rain(seed_rain, patches);
+        yearly.set_transitions(factors);
+        mean_field_populations skipping = yearly;
+        for (int repeat = 0; repeat < 2; repeat++) {            // the second step reuses the cached powers
+            for (int year = 0; year < k; year++) {
+                yearly.advance();
+            }
+            skipping.advance(k);
+        }
+        for (int s = 0; s < N_stages; s++) {
+            for (int j = 0; j < N_species; j++) {
+                for (size_t i = 0; i < patches.size(); i++) {
+                    REQUIRE(skipping.expected_count(s, j, i) == Approx(yearly.expected_count(s, j, i)).epsilon(1e-4).margin(1e-4));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Benchmark expected values against stochastic population dynamics", "[.][benchmark]") {
+    std::mt19937 gen(1);
+    const patch_grid start = make_random_grid(300, 300, gen);
+    transition_factors factors;
+    factors.update(start);
+    BENCHMARK_ADVANCED("per individual draws, 100 years, 300 x 300")(Catch::Benchmark::Chronometer meter) {
+        patch_grid patches = start;
+        meter.measure([&] {
+            for (int year = 0; year < 100; year++) {
+                advance_populations(patches, factors, 1, year);
+            }
+        });
+    };
+    BENCHMARK_ADVANCED("expected values, 100 single years, 300 x 300")(Catch::Benchmark::Chronometer meter) {
+        mean_field_populations expected;
+        expected.reset(start);
+        expected.set_transitions(factors);
+        meter.measure([&] {
+            for (int year = 0; year < 100; year++) {
+                expected.advance();
+            }
+        });
+    };
+    BENCHMARK_ADVANCED("expected values, one step of 100 years with new powers, 300 x 300")(Catch::Benchmark::Chronometer meter) {
+        mean_field_populations expected;
+        expected.reset(start);
+        meter.measure([&] {
+            expected.set_transitions(factors);
+            expected.advance(100);
+        });
+    };
+    BENCHMARK_ADVANCED("expected values, one step of 100 years with cached powers, 300 x 300")(Catch::Benchmark::Chronometer meter) {
+        mean_field_populations expected;
+        expected.reset(start);
+        expected.set_transitions(factors);
+        expected.advance(100);
+        meter.measure([&] { expected.advance(100); });
+    };
+}
@@ -0,0 +1,36 @@
+// test the thread pool of parallel.h
+#include "catch.hpp"
+#include "../post_fire_simulation/parallel.h"
+#include <atomic>
+#include <vector>
+
+TEST_CASE("Test thread pool runs every thread once per call") {
+    thread_pool pool;
+    REQUIRE(pool.size() == 1);
+    for (int N_threads : {1, 3, 8, 2}) {
+        pool.resize(N_threads);
+        REQUIRE(pool.size() == N_threads);
+        for (int call = 0; call < 20; call++) {
+            std::vector<std::atomic<int>> calls(N_threads);
+            for (auto& c : calls) {
+                c = 0;
+            }
+            pool.run([&](int thread) {
+                calls[thread]++;
+            });
+            for (auto& c : calls) {
+                REQUIRE(c == 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("Test thread pool of size 1 runs on the calling thread") {
+    thread_pool pool(1);
+    std::thread::id caller = std::this_thread::get_id();
+    std::thread::id runner;
+    pool.run([&](int) {
+        runner = std::this_thread::get_id();
+    });
+    REQUIRE(runner == caller);
+}
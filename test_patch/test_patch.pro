@@ -1,14 +1,72 @@
 TEMPLATE = app
 CONFIG += console c++17
 CONFIG -= app_bundle
-QT += testlib
+QT += testlib gui
 
-CONFIG -= qt
+# the tree class uses QImage colors, benchmarks are hidden test cases run with "[benchmark]"
+DEFINES += CATCH_CONFIG_ENABLE_BENCHMARKING
 
 SOURCES += \
+        ../post_fire_simulation/alias_table.cpp \
+        ../post_fire_simulation/analysis_pipeline.cpp \
+        ../post_fire_simulation/canopy_shading.cpp \
+        ../post_fire_simulation/dispersal.cpp \
+        ../post_fire_simulation/dispersal_stencil.cpp \
+        ../post_fire_simulation/distance_field.cpp \
+        ../post_fire_simulation/distance_transform.cpp \
+        ../post_fire_simulation/fft.cpp \
+        ../post_fire_simulation/mean_field_populations.cpp \
+        ../post_fire_simulation/parallel.cpp \
         ../post_fire_simulation/patch.cpp \
-        test_patch.cpp
+        ../post_fire_simulation/patch_grid.cpp \
+        ../post_fire_simulation/population_dynamics.cpp \
+        ../post_fire_simulation/population_store.cpp \
+        ../post_fire_simulation/seed_rain_field.cpp \
+        ../post_fire_simulation/seed_trajectory.cpp \
+        ../post_fire_simulation/tree.cpp \
+        ../post_fire_simulation/tree_index.cpp \
+        ../post_fire_simulation/year_step.cpp \
+        test_alias_table.cpp \
+        test_analysis_pipeline.cpp \
+        test_canopy_shading.cpp \
+        test_dispersal_kernel.cpp \
+        test_distance_field.cpp \
+        test_distance_transform.cpp \
+        test_mean_field_populations.cpp \
+        test_parallel.cpp \
+        test_patch.cpp \
+        test_patch_grid.cpp \
+        test_population_dynamics.cpp \
+        test_population_store.cpp \
+        test_seed_rain_field.cpp \
+        test_seed_trajectory.cpp \
+        test_sim_random.cpp \
+        test_tree_index.cpp \
+        test_year_step.cpp
 
 HEADERS += \
+    ../post_fire_simulation/alias_table.h \
+    ../post_fire_simulation/analysis_pipeline.h \
+    ../post_fire_simulation/canopy_shading.h \
+    ../post_fire_simulation/dispersal.h \
+    ../post_fire_simulation/dispersal_kernel.h \
+    ../post_fire_simulation/dispersal_stencil.h \
+    ../post_fire_simulation/distance_field.h \
+    ../post_fire_simulation/distance_transform.h \
+    ../post_fire_simulation/fft.h \
+    ../post_fire_simulation/mean_field_populations.h \
+    ../post_fire_simulation/parallel.h \
     ../post_fire_simulation/patch.h \
-    catch.hpp
+    ../post_fire_simulation/patch_grid.h \
+    ../post_fire_simulation/population_dynamics.h \
+    ../post_fire_simulation/population_kernels.h \
+    ../post_fire_simulation/population_store.h \
+    ../post_fire_simulation/population_traits.h \
+    ../post_fire_simulation/seed_rain_field.h \
+    ../post_fire_simulation/seed_trajectory.h \
+    ../post_fire_simulation/sim_random.h \
+    ../post_fire_simulation/tree.h \
+    ../post_fire_simulation/tree_index.h \
+    ../post_fire_simulation/year_step.h \
+    catch.hpp \
+    test_trees.h
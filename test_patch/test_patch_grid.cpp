@@ -0,0 +1,218 @@
+// test patch_grid.cpp and the seed deposition in dispersal.cpp
+#include "catch.hpp"
+#include "../post_fire_simulation/patch_grid.h"
+#include "../post_fire_simulation/dispersal.h"
+#include "test_trees.h"
+#include <vector>
+#include <random>
+
+TEST_CASE("Test patch grid coordinate lookup") {
+    patch_grid grid(30, 20);
+
+    SECTION("Test grid size") {
+        REQUIRE(grid.size() == 600);
+        REQUIRE(grid.get_x_size() == 30);
+        REQUIRE(grid.get_y_size() == 20);
+    }
+    SECTION("Test every patch is found at its own coordinates") {
+        for (int x = 0; x < 30; x++) {
+            for (int y = 0; y < 20; y++) {
+                REQUIRE(grid.at(x, y).x_y_cor[0] == x);
+                REQUIRE(grid.at(x, y).x_y_cor[1] == y);
+            }
+        }
+    }
+    SECTION("Test map extent") {
+        REQUIRE(grid.contains(0, 0));
+        REQUIRE(grid.contains(29, 19));
+        REQUIRE_FALSE(grid.contains(-1, 0));
+        REQUIRE_FALSE(grid.contains(30, 0));
+        REQUIRE_FALSE(grid.contains(0, 20));
+    }
+    SECTION("Test reset clears the populations") {
+        grid.at(3, 4).update_N_seeds(5, 'b');
+        grid.reset(30, 20);
+        REQUIRE(grid.at(3, 4).N_seeds[0] == 0);
+    }
+}
+
+TEST_CASE("Test seeds are deposited inside the dispersal range of their tree") {
+    patch_grid grid(100, 100);
+    std::vector<tree> trees = {make_tree(0, 50, 50, 'o')};
+    std::mt19937 gen(42);
+    for (int year = 0; year < 10; year++) {
+        disperse_seeds(trees, grid, gen);
+    }
+
+    int N_oak_seeds = 0;
+    for (int x = 0; x < 100; x++) {
+        for (int y = 0; y < 100; y++) {
+            const patch& p = grid.at(x, y);
+            REQUIRE(p.N_seeds[0] == 0);                 // no birch tree on the map
+            if (p.N_seeds[1] > 0) {
+                REQUIRE(std::abs(x - 50) <= trees[0].dispersal_factor);
+                REQUIRE(std::abs(y - 50) <= trees[0].dispersal_factor);
+            }
+            N_oak_seeds += p.N_seeds[1];
+        }
+    }
+    REQUIRE(N_oak_seeds > 0);
+    REQUIRE(N_oak_seeds <= 10 * trees[0].max_seed_production);
+}
+
+TEST_CASE("Test occupancy of the patches follows the deposited seeds") {
+    patch_grid grid(100, 80);
+    REQUIRE(grid.N_occupied() == 0);
+    std::mt19937 gen(8);
+    std::vector<tree> trees = make_random_trees(40, 100, 80, 0.5f, gen);
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+    disperse_seeds(trees, grid, gen);
+    thread_pool pool(2);
+    disperse_seeds_parallel(trees, stencils, grid, 3, pool);
+
+    std::vector<int> visited;
+    grid.for_each_occupied([&](size_t i) { visited.push_back(static_cast<int>(i)); });
+    std::vector<int> expected;
+    for (size_t i = 0; i < grid.size(); i++) {
+        if (!grid[i].is_empty()) {
+            expected.push_back(static_cast<int>(i));
+        }
+    }
+    REQUIRE(!expected.empty());
+    REQUIRE(visited == expected);                               // every non-empty patch, in index order
+    REQUIRE(grid.N_occupied() == expected.size());
+
+    grid[expected[0]].N_seeds = {0, 0};
+    grid[expected[0]].N_height_class_2[1] = 4;                  // counts written directly
+    grid[expected[1]].N_seeds = {0, 0};
+    grid[7].N_height_class_4[0] = 1;
+    grid.update_occupancy();
+    REQUIRE(grid.is_occupied(expected[0]));
+    REQUIRE_FALSE(grid.is_occupied(expected[1]));
+    REQUIRE(grid.is_occupied(7));
+
+    grid.reset(100, 80);
+    REQUIRE(grid.N_occupied() == 0);
+}
+
+TEST_CASE("Benchmark seed deposition for growing map area at constant seed count", "[.][benchmark]") {
+    std::mt19937 gen(1);
+    std::vector<tree> trees = make_random_trees(2700, 300, 300, 0.5f, gen);   // 300 trees/ha on the default map
+    for (int size : {300, 600, 1200}) {
+        patch_grid grid(size, size);
+        BENCHMARK("one year of dispersal, map " + std::to_string(size) + " x " + std::to_string(size)) {
+            disperse_seeds(trees, grid, gen);
+        };
+    }
+}
+
+TEST_CASE("Benchmark seed deposition for growing seed count at constant map area", "[.][benchmark]") {
+    patch_grid grid(300, 300);
+    for (int N_trees : {900, 2700, 8100}) {
+        std::mt19937 gen(1);
+        std::vector<tree> trees = make_random_trees(N_trees, 300, 300, 0.5f, gen);
+        BENCHMARK("one year of dispersal, " + std::to_string(N_trees) + " trees") {
+            disperse_seeds(trees, grid, gen);
+        };
+    }
+}
+
+TEST_CASE("Test parallel dispersal is identical for any number of threads") {
+    std::mt19937 gen(5);
+    std::vector<tree> trees = make_random_trees(500, 100, 80, 0.4f, gen);
+    trees[3].set_burnt();
+
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+    patch_grid reference(100, 80);
+    thread_pool single_thread(1);
+    disperse_seeds_parallel(trees, stencils, reference, 12345, single_thread);
+
+    int N_seeds = 0;
+    for (const patch& p : reference) {
+        N_seeds += p.N_seeds[0] + p.N_seeds[1];
+    }
+    REQUIRE(N_seeds > 0);
+
+    for (int N_threads : {2, 3, 8, 64}) {
+        patch_grid grid(100, 80);
+        thread_pool pool(N_threads);
+        disperse_seeds_parallel(trees, stencils, grid, 12345, pool);
+        for (size_t i = 0; i < grid.size(); i++) {
+            REQUIRE(grid[i].N_seeds[0] == reference[i].N_seeds[0]);
+            REQUIRE(grid[i].N_seeds[1] == reference[i].N_seeds[1]);
+        }
+    }
+
+    SECTION("Test another seed gives another seed rain") {
+        patch_grid grid(100, 80);
+        thread_pool pool(4);
+        disperse_seeds_parallel(trees, stencils, grid, 54321, pool);
+        int N_different = 0;
+        for (size_t i = 0; i < grid.size(); i++) {
+            N_different += grid[i].N_seeds[0] != reference[i].N_seeds[0];
+        }
+        REQUIRE(N_different > 0);
+    }
+}
+
+TEST_CASE("Benchmark strong scaling of the parallel dispersal", "[.][benchmark]") {
+    std::mt19937 gen(1);
+    std::vector<tree> trees = make_random_trees(27000, 300, 300, 0.5f, gen);  // 3000 trees/ha on the default map
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+    patch_grid grid(300, 300);
+    for (int N_threads : {1, 2, 4, 8, 16, 32, 64}) {
+        thread_pool pool(N_threads);
+        BENCHMARK("one year of parallel dispersal, " + std::to_string(N_threads) + " threads") {
+            disperse_seeds_parallel(trees, stencils, grid, 1, pool);
+        };
+    }
+}
+
+TEST_CASE("Test tiled seed scatter counts the same seeds as plain scatter") {
+    std::mt19937 gen(11);
+    std::vector<tree> trees = make_random_trees(800, 170, 130, 0.5f, gen);
+    trees[10].set_burnt();
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+
+    seed_count_raster plain;
+    plain.reset(170, 130);
+    scatter_seeds(trees, stencils, plain, 99);
+
+    for (int N_threads : {1, 4}) {
+        thread_pool pool(N_threads);
+        for (int tile_size : {8, 32, 100}) {
+            seed_count_raster tiled;
+            tiled.reset(170, 130);
+            scatter_seeds_tiled(trees, stencils, tiled, 99, pool, tile_size);
+            REQUIRE(tiled.counts[0] == plain.counts[0]);
+            REQUIRE(tiled.counts[1] == plain.counts[1]);
+        }
+    }
+}
+
+TEST_CASE("Benchmark tiled against plain seed scatter on a 3000 x 3000 landscape", "[.][benchmark]") {
+    // run e.g. with "perf stat -e cache-misses,cache-references" and a name filter to compare cache miss counts
+    std::mt19937 gen(1);
+    std::vector<tree> trees = make_random_trees(90000, 3000, 3000, 0.5f, gen);     // 100 trees/ha
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+    seed_count_raster raster;
+    raster.reset(3000, 3000);
+    thread_pool single_thread(1);
+    BENCHMARK("plain scatter, 3000 x 3000") {
+        scatter_seeds(trees, stencils, raster, 1);
+    };
+    for (int tile_size : {16, 32, 64, 128}) {
+        BENCHMARK("tiled scatter, 3000 x 3000, tile " + std::to_string(tile_size)) {
+            scatter_seeds_tiled(trees, stencils, raster, 1, single_thread, tile_size);
+        };
+    }
+    thread_pool pool(8);
+    BENCHMARK("tiled scatter, 3000 x 3000, 8 threads") {
+        scatter_seeds_tiled(trees, stencils, raster, 1, pool);
+    };
+}
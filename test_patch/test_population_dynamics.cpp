@@ -0,0 +1,656 @@
+// test population_dynamics.cpp against the original MainWindow::perform_pop_dynamics()
+#include "catch.hpp"
+#include "../post_fire_simulation/population_dynamics.h"
+#include "../post_fire_simulation/population_kernels.h"
+#include "../post_fire_simulation/sim_random.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <random>
+
+// the original procedure, factors recomputed for every patch and species each year
+template <class Engine>
+static void original_pop_dynamics(patch_grid& patches, Engine& gen) {
+    std::uniform_real_distribution<float> rand_float_01(0.0f, 1.0f);
+    for(unsigned int i = 0; i < patches.size(); i++){
+        for (int j = 0; j < 2; j++) {
+            float mortality_factor = patches[i].mortality_rate * (1 - patches[i].light_availability) * (1 - patches[i].water_availability);
+            float growth_factor =    patches[i].growth_rate *    patches[i].light_availability * patches[i].water_availability;
+            if(patches[i].N_height_class_4[j] > 0){
+                for(int k = 0; k < patches[i].N_height_class_4[j]; k++){
+                    if(rand_float_01(gen) < mortality_factor){
+                        patches[i].N_height_class_4[j] -= 1;
+                    }
+                }
+            }
+            if(patches[i].N_height_class_3[j] > 0){
+                for(int k = 0; k < patches[i].N_height_class_3[j]; k++){
+                    if(rand_float_01(gen) < mortality_factor){
+                        patches[i].N_height_class_3[j] -= 1;
+                    }
+                    if(rand_float_01(gen) < growth_factor){
+                        patches[i].N_height_class_4[j] += 1;
+                        patches[i].N_height_class_3[j] -= 1;
+                    }
+                }
+            }
+            if(patches[i].N_height_class_2[j] > 0){
+                for(int k = 0; k < patches[i].N_height_class_2[j]; k++){
+                    if(rand_float_01(gen) < mortality_factor){
+                        patches[i].N_height_class_2[j] -= 1;
+                    }
+                    if(rand_float_01(gen) < growth_factor){
+                        patches[i].N_height_class_3[j] += 1;
+                        patches[i].N_height_class_2[j] -= 1;
+                    }
+                }
+            }
+            if(patches[i].N_height_class_1[j] > 0){
+                for(int k = 0; k < patches[i].N_height_class_1[j]; k++){
+                    if(rand_float_01(gen) < mortality_factor){
+                        patches[i].N_height_class_1[j] -= 1;
+                    }
+                    if(rand_float_01(gen) < patches[i].growth_rate){
+                        patches[i].N_height_class_2[j] += 1;
+                        patches[i].N_height_class_1[j] -= 1;
+                    }
+                }
+            }
+            if(patches[i].N_seeds[j] > 0){
+                for (int k = 0; k < patches[i].N_seeds[j]; k++) {
+                    if (rand_float_01(gen) < mortality_factor) {
+                        patches[i].N_seeds[j] -= 1;
+                    }
+                    if (rand_float_01(gen) < growth_factor) {
+                        patches[i].N_height_class_1[j] += 1;
+                        patches[i].N_seeds[j] -= 1;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// patches with random populations and environments like after MainWindow::setup_min_distance_to_tree()
+static patch_grid make_populated_grid(int x_size, int y_size, int max_count, std::mt19937& gen) {
+    patch_grid patches(x_size, y_size);
+    std::uniform_int_distribution<int> rand_count(0, max_count);
+    std::uniform_real_distribution<float> rand_float_01(0.0f, 1.0f);
+    for (auto& p : patches) {
+        for (int j = 0; j < 2; j++) {
+            p.N_seeds[j] = rand_count(gen);
+            p.N_height_class_1[j] = rand_count(gen) / 2;
+            p.N_height_class_2[j] = rand_count(gen) / 3;
+            p.N_height_class_3[j] = rand_count(gen) / 4;
+            p.N_height_class_4[j] = rand_count(gen) / 5;
+        }
+        p.light_availability = rand_float_01(gen);
+        p.water_availability = rand_float_01(gen) < 0.2f ? 0.5f : 1.0f;
+    }
+    patches.update_occupancy();
+    return patches;
+}
+
+static bool same_populations(const patch_grid& a, const patch_grid& b) {
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].N_seeds != b[i].N_seeds || a[i].N_height_class_1 != b[i].N_height_class_1 ||
+            a[i].N_height_class_2 != b[i].N_height_class_2 || a[i].N_height_class_3 != b[i].N_height_class_3 ||
+            a[i].N_height_class_4 != b[i].N_height_class_4) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Test population dynamics with precomputed factors equal the original procedure") {
+    std::mt19937 setup_gen(17);
+    patch_grid patches = make_populated_grid(40, 30, 30, setup_gen);
+    patch_grid original = patches;
+    transition_factors factors;
+    REQUIRE_FALSE(factors.is_valid());
+    factors.update(patches);
+    REQUIRE(factors.is_valid());
+
+    std::mt19937 gen(5);
+    std::mt19937 original_gen(5);
+    for (int year = 0; year < 10; year++) {
+        advance_populations(patches, factors, gen);
+        original_pop_dynamics(original, original_gen);
+        REQUIRE(same_populations(patches, original));
+    }
+    REQUIRE(gen == original_gen);                               // same number of draws
+}
+
+TEST_CASE("Test population dynamics with per-patch streams") {
+    std::mt19937 setup_gen(23);
+    patch_grid patches = make_populated_grid(20, 15, 30, setup_gen);
+    transition_factors factors;
+    factors.update(patches);
+    const std::uint64_t run_seed = 99;
+
+    SECTION("Test each patch draws the original procedure from its own stream") {
+        patch_grid original = patches;
+        for (int year = 0; year < 5; year++) {
+            advance_populations(patches, factors, run_seed, year);
+            for (size_t i = 0; i < original.size(); i++) {
+                patch_grid single(1, 1);
+                single[0] = original[i];
+                philox4x32 patch_gen(run_seed, random_purpose::demography, year, i);
+                original_pop_dynamics(single, patch_gen);
+                original[i] = single[0];
+            }
+            REQUIRE(same_populations(patches, original));
+        }
+    }
+    SECTION("Test a patch does not depend on which other patches are drawn") {
+        for (int mode = 0; mode < 2; mode++) {
+            patch_grid all = patches;
+            patch_grid odd = patches;
+            for (size_t i = 0; i < odd.size(); i += 2) {
+                odd[i] = patch();
+            }
+            odd.update_occupancy();
+            for (int year = 0; year < 5; year++) {
+                if (mode == 0) {
+                    advance_populations(all, factors, run_seed, year);
+                    advance_populations(odd, factors, run_seed, year);
+                } else {
+                    advance_cohorts(all, factors, run_seed, year);
+                    advance_cohorts(odd, factors, run_seed, year);
+                }
+            }
+            for (size_t i = 1; i < all.size(); i += 2) {
+                REQUIRE(all[i].get_all_N_seeds_saplings() == odd[i].get_all_N_seeds_saplings());
+                REQUIRE(all[i].N_height_class_4 == odd[i].N_height_class_4);
+            }
+        }
+    }
+    SECTION("Test the years draw different numbers") {
+        patch_grid year_0 = patches;
+        patch_grid year_1 = patches;
+        advance_populations(year_0, factors, run_seed, 0);
+        advance_populations(year_1, factors, run_seed, 1);
+        REQUIRE_FALSE(same_populations(year_0, year_1));
+    }
+}
+
+TEST_CASE("Test parallel population dynamics do not depend on the number of threads") {
+    std::mt19937 setup_gen(31);
+    patch_grid start = make_populated_grid(37, 29, 20, setup_gen);
+    for (size_t i = 0; i < start.size(); i += 3) {
+        start[i] = patch();                                     // some extinct patches
+    }
+    start.update_occupancy();
+    transition_factors factors;
+    factors.update(start);
+    thread_pool pool;
+
+    for (int mode = 0; mode < 2; mode++) {
+        patch_grid serial = start;
+        for (int year = 0; year < 4; year++) {
+            if (mode == 0) {
+                advance_populations(serial, factors, 11, year);
+            } else {
+                advance_cohorts(serial, factors, 11, year);
+            }
+        }
+        for (int N_threads : {1, 2, 3, 8}) {
+            pool.resize(N_threads);
+            for (int tile_blocks : {1, 4, 100}) {
+                patch_grid parallel = start;
+                for (int year = 0; year < 4; year++) {
+                    if (mode == 0) {
+                        advance_populations_parallel(parallel, factors, 11, year, pool, tile_blocks);
+                    } else {
+                        advance_cohorts_parallel(parallel, factors, 11, year, pool, tile_blocks);
+                    }
+                }
+                REQUIRE(same_populations(parallel, serial));
+                for (size_t i = 0; i < parallel.size(); i++) {
+                    REQUIRE(parallel.is_occupied(i) == serial.is_occupied(i));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Test transition factors follow the environment only after an update") {
+    patch_grid patches(3, 2);
+    patches[4].light_availability = 0.5f;
+    transition_factors factors;
+    factors.update(patches);
+    REQUIRE(factors.mortality(4) == patches[4].mortality_rate * (1 - 0.5f) * (1 - patches[4].water_availability));
+    REQUIRE(factors.growth(4) == patches[4].growth_rate * 0.5f * patches[4].water_availability);
+    REQUIRE(factors.germination_growth(4) == patches[4].growth_rate);
+
+    patches[4].light_availability = 1.0f;
+    factors.invalidate();
+    REQUIRE_FALSE(factors.is_valid());
+    factors.update(patches);
+    REQUIRE(factors.growth(4) == patches[4].growth_rate * patches[4].water_availability);
+}
+
+TEST_CASE("Test patches with the same environment share one class") {
+    patch_grid patches(40, 30);
+    for (int x = 0; x < 40; x++) {
+        patches.at(x, 7).light_availability = 0.5f;             // one row in half shade
+        patches.at(x, 8).light_availability = 1.0f - 1.0f / std::sqrt(2.0f);
+    }
+    patches.at(3, 20).water_availability = 0.5f;
+    patches.at(30, 2).light_availability = -std::numeric_limits<float>::infinity();    // a tree on the patch, factors are NaN
+    patches.at(31, 2).light_availability = -std::numeric_limits<float>::infinity();
+    transition_factors factors;
+    factors.update(patches);
+
+    REQUIRE(factors.N_classes() == 5);
+    REQUIRE(factors.environment_class.size() == patches.size());
+    REQUIRE(factors.environment_class[patches.index(0, 7)] == factors.environment_class[patches.index(39, 7)]);
+    REQUIRE(factors.environment_class[patches.index(0, 0)] == factors.environment_class[patches.index(39, 29)]);
+    REQUIRE(factors.environment_class[patches.index(30, 2)] == factors.environment_class[patches.index(31, 2)]);
+    REQUIRE(factors.environment_class[patches.index(0, 7)] != factors.environment_class[patches.index(0, 8)]);
+    for (size_t i = 0; i < patches.size(); i++) {
+        const patch& p = patches[i];
+        const float mortality = p.mortality_rate * (1 - p.light_availability) * (1 - p.water_availability);
+        const float growth = p.growth_rate * p.light_availability * p.water_availability;
+        if (std::isnan(mortality)) {
+            REQUIRE(std::isnan(factors.mortality(i)));
+        } else {
+            REQUIRE(factors.mortality(i) == mortality);
+            REQUIRE(factors.growth(i) == growth);
+        }
+    }
+
+    SECTION("Test the binomial tables of a class") {
+        const environment_class_factors& half_shade = factors.of_patch(patches.index(0, 7));
+        REQUIRE(half_shade.mortality_draws.probability == 0.0f);     // full water, no mortality
+        REQUIRE(half_shade.growth_draws.probability == transition_probability(half_shade.growth));
+        REQUIRE_FALSE(half_shade.growth_draws.flipped);
+        REQUIRE(half_shade.growth_draws.q_power.size() == 140);       // N = 0 .. 139 are drawn by inversion, N * p < 14 with p = 0.1
+        REQUIRE(half_shade.growth_draws.q_power[3] == std::pow(half_shade.growth_draws.q, 3));
+        REQUIRE(factors.of_patch(patches.index(30, 2)).mortality_draws.probability == 0.0f);
+    }
+}
+
+// per-individual draws with the ordering of advance_cohorts(): stages from height class 4 down,
+// every individual of the stage at the start of its turn dies or else may grow
+static void individual_cohort_draws(patch& p, float mortality, float growth, float germination_growth, std::mt19937& gen) {
+    std::uniform_real_distribution<float> rand_float_01(0.0f, 1.0f);
+    stage_counts* stages[5] = {&p.N_seeds, &p.N_height_class_1, &p.N_height_class_2, &p.N_height_class_3, &p.N_height_class_4};
+    for (int j = 0; j < 2; j++) {
+        for (int stage = 4; stage >= 0; stage--) {
+            int& N_stage = (*stages[stage])[j];
+            const int N_start = N_stage;
+            for (int k = 0; k < N_start; k++) {
+                if (rand_float_01(gen) < mortality) {
+                    N_stage--;
+                } else if (stage < 4 && rand_float_01(gen) < (stage == 1 ? germination_growth : growth)) {
+                    N_stage--;
+                    (*stages[stage + 1])[j]++;
+                }
+            }
+        }
+    }
+}
+
+static std::vector<int> stage_counts(const patch& p, int j) {
+    return {p.N_seeds[j], p.N_height_class_1[j], p.N_height_class_2[j], p.N_height_class_3[j], p.N_height_class_4[j]};
+}
+
+static patch_grid make_cohort_patch(float light, float water) {
+    patch_grid patches(1, 1);
+    patches[0].light_availability = light;
+    patches[0].water_availability = water;
+    for (int j = 0; j < 2; j++) {
+        patches[0].N_seeds[j] = 300 * (j + 1);
+        patches[0].N_height_class_1[j] = 60;
+        patches[0].N_height_class_2[j] = 40;
+        patches[0].N_height_class_3[j] = 25;
+        patches[0].N_height_class_4[j] = 10;
+    }
+    patches.mark_occupied(0);
+    return patches;
+}
+
+TEST_CASE("Test binomial cohort draws have the distribution of per-individual draws in the same order") {
+    const int N_replicates = 20000;
+    for (float light : {0.3f, 0.8f}) {
+        for (float water : {0.5f, 1.0f}) {
+            patch_grid start = make_cohort_patch(light, water);
+            transition_factors factors;
+            factors.update(start);
+            double sum[2][2][5] = {};                           // [path][species][stage]
+            double sum_squares[2][2][5] = {};
+            std::mt19937 gen(light * 100 + water * 10);
+            for (int r = 0; r < N_replicates; r++) {
+                patch_grid cohorts = start;
+                advance_cohorts(cohorts, factors, gen);
+                patch individuals = start[0];
+                individual_cohort_draws(individuals, factors.mortality(0), factors.growth(0), factors.germination_growth(0), gen);
+                for (int j = 0; j < 2; j++) {
+                    std::vector<int> counts[2] = {stage_counts(cohorts[0], j), stage_counts(individuals, j)};
+                    for (int path = 0; path < 2; path++) {
+                        for (int stage = 0; stage < 5; stage++) {
+                            sum[path][j][stage] += counts[path][stage];
+                            sum_squares[path][j][stage] += static_cast<double>(counts[path][stage]) * counts[path][stage];
+                        }
+                    }
+                }
+            }
+            for (int j = 0; j < 2; j++) {
+                for (int stage = 0; stage < 5; stage++) {
+                    double mean[2], variance[2];
+                    for (int path = 0; path < 2; path++) {
+                        mean[path] = sum[path][j][stage] / N_replicates;
+                        variance[path] = sum_squares[path][j][stage] / N_replicates - mean[path] * mean[path];
+                    }
+                    // difference of the means within 5 standard errors, variances within 10 %
+                    REQUIRE(std::abs(mean[0] - mean[1]) <= 5 * std::sqrt((variance[0] + variance[1]) / N_replicates) + 1e-9);
+                    REQUIRE(variance[0] == Approx(variance[1]).epsilon(0.1).margin(1e-6));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Test binomial cohort draws stay close to the original per-individual procedure") {
+    // the original loop re-reads its bound after every draw, so fewer individuals are drawn as the stage shrinks
+    // and a dying individual may still grow, the mean populations differ by up to about a fifth
+    const int N_replicates = 2000;
+    patch_grid start = make_cohort_patch(0.5f, 1.0f);
+    transition_factors factors;
+    factors.update(start);
+    double sum[2][5] = {};
+    std::mt19937 gen(7);
+    for (int r = 0; r < N_replicates; r++) {
+        patch_grid cohorts = start;
+        patch_grid original = start;
+        for (int year = 0; year < 5; year++) {
+            advance_cohorts(cohorts, factors, gen);
+            advance_populations(original, factors, gen);
+        }
+        for (int stage = 0; stage < 5; stage++) {
+            sum[0][stage] += stage_counts(cohorts[0], 0)[stage];
+            sum[1][stage] += stage_counts(original[0], 0)[stage];
+        }
+    }
+    for (int stage = 0; stage < 5; stage++) {
+        REQUIRE(sum[0][stage] == Approx(sum[1][stage]).epsilon(0.25));
+    }
+}
+
+TEST_CASE("Test binomial cohort draws of huge populations") {
+    patch_grid patches = make_cohort_patch(0.5f, 0.5f);
+    patches[0].N_seeds[1] = 100000000;
+    patches[0].light_availability = -INFINITY;                 // patch with a tree on it, the factors are NaN and -inf
+    patches[0].water_availability = 1.0f;
+    transition_factors factors;
+    factors.update(patches);
+    std::mt19937 gen(1);
+    patch_grid before = patches;
+    advance_cohorts(patches, factors, gen);
+    for (int j = 0; j < 2; j++) {                               // nobody dies or grows except by the plain height class 1 growth
+        REQUIRE(patches[0].N_seeds[j] == before[0].N_seeds[j]);
+        REQUIRE(patches[0].N_height_class_4[j] == before[0].N_height_class_4[j]);
+    }
+
+    patches = make_cohort_patch(0.5f, 0.5f);
+    patches[0].N_seeds[1] = 100000000;
+    factors.update(patches);
+    advance_cohorts(patches, factors, gen);
+    int total = 0;
+    for (int stage : stage_counts(patches[0], 1)) {
+        REQUIRE(stage >= 0);
+        total += stage;
+    }
+    REQUIRE(total < 100000000 + 60 + 40 + 25 + 10);
+    REQUIRE(patches[0].N_seeds[1] == Approx(100000000 * (1 - factors.mortality(0)) * (1 - factors.growth(0))).epsilon(0.001));
+}
+
+TEST_CASE("Test extinct patches are no longer occupied") {
+    patch_grid patches(4, 4);
+    patches[5].N_seeds = {3, 0};
+    patches[6].N_height_class_2 = {0, 2};
+    patches.update_occupancy();
+    for (auto& p : patches) {
+        p.light_availability = 0.0f;                            // mortality 0.2 * 1 * 0.5, no growth except height class 1
+        p.water_availability = 0.5f;
+    }
+    transition_factors factors;
+    factors.update(patches);
+    std::mt19937 gen(2);
+    for (int year = 0; year < 200 && patches.N_occupied() > 0; year++) {
+        advance_cohorts(patches, factors, gen);
+        for (size_t i = 0; i < patches.size(); i++) {
+            REQUIRE(patches.is_occupied(i) == !patches[i].is_empty());
+        }
+    }
+    REQUIRE(patches.N_occupied() == 0);
+}
+
+TEST_CASE("Test store procedures of the model configuration equal the patch grid procedures") {
+    std::mt19937 setup_gen(41);
+    patch_grid patches = make_populated_grid(25, 20, 30, setup_gen);
+    transition_factors factors;
+    factors.update(patches);
+    population_store store = patches.get_populations();
+    const size_t N_counts = N_stages * N_species * patches.size();
+
+    for (int year = 0; year < 5; year++) {
+        if (year % 2 == 0) {
+            advance_populations(patches, factors, 7, year);
+            advance_populations(store, factors, 7, year);
+        } else {
+            advance_cohorts(patches, factors, 7, year);
+            advance_cohorts(store, factors, 7, year);
+        }
+        const int* grid_counts = patches.get_populations().counts(0, 0);
+        REQUIRE(std::equal(grid_counts, grid_counts + N_counts, store.counts(0, 0)));
+    }
+}
+
+TEST_CASE("Test population dynamics of a store with 6 species and 8 stages") {
+    typedef basic_population_store<6, 8> large_store;
+    patch_grid environment(12, 10);                 // the factors still come from the environment of a patch grid
+    for (auto& p : environment) {
+        p.light_availability = 1.0f;                // no mortality
+        p.growth_rate = 1.0f;                       // everything grows
+    }
+    transition_factors factors;
+    factors.update(environment);
+    large_store store;
+    store.reset(environment.size());
+    for (int j = 0; j < large_store::N_species; j++) {
+        for (size_t i = 0; i < store.size(); i++) {
+            store.counts(stage_seeds, j)[i] = j + static_cast<int>(i % 7);
+        }
+    }
+
+    SECTION("Test every individual of the cohorts advances one stage a year") {
+        large_store populations = store;
+        for (int year = 0; year < 10; year++) {
+            advance_cohorts(populations, factors, 3, year);
+            const int stage = std::min(year + 1, large_store::N_stages - 1);   // the last stage keeps its individuals
+            for (int j = 0; j < large_store::N_species; j++) {
+                for (size_t i = 0; i < store.size(); i++) {
+                    REQUIRE(populations.counts(stage, j)[i] == store.counts(stage_seeds, j)[i]);
+                }
+            }
+        }
+    }
+    SECTION("Test random growth keeps all individuals without mortality") {
+        for (auto& p : environment) {
+            p.growth_rate = 0.2f;
+        }
+        factors.update(environment);
+        for (int mode = 0; mode < 2; mode++) {
+            large_store populations = store;
+            for (int year = 0; year < 6; year++) {
+                if (mode == 0) {
+                    advance_populations(populations, factors, 3, year);
+                } else {
+                    advance_cohorts(populations, factors, 3, year);
+                }
+            }
+            for (int j = 0; j < large_store::N_species; j++) {
+                for (size_t i = 0; i < store.size(); i++) {
+                    int total = 0;
+                    for (int s = 0; s < large_store::N_stages; s++) {
+                        total += populations.counts(s, j)[i];
+                    }
+                    REQUIRE(total == store.counts(stage_seeds, j)[i]);
+                    REQUIRE(populations.counts(large_store::N_stages - 1, j)[i] == 0);  // seeds need 7 years to reach the last stage
+                }
+            }
+            REQUIRE(populations.counts(stage_seeds, 5)[6] < store.counts(stage_seeds, 5)[6]);
+        }
+    }
+}
+
+TEST_CASE("Benchmark population dynamics with precomputed factors against the original procedure", "[.][benchmark]") {
+    std::mt19937 setup_gen(1);
+    const patch_grid start = make_populated_grid(300, 300, 6, setup_gen);
+    transition_factors factors;
+    factors.update(start);
+    BENCHMARK_ADVANCED("original, 300 x 300")(Catch::Benchmark::Chronometer meter) {
+        patch_grid patches = start;
+        std::mt19937 gen(3);
+        meter.measure([&] { original_pop_dynamics(patches, gen); });
+    };
+    BENCHMARK_ADVANCED("precomputed factors, 300 x 300")(Catch::Benchmark::Chronometer meter) {
+        patch_grid patches = start;
+        std::mt19937 gen(3);
+        meter.measure([&] { advance_populations(patches, factors, gen); });
+    };
+    BENCHMARK_ADVANCED("precomputed factors, per-patch streams, 300 x 300")(Catch::Benchmark::Chronometer meter) {
+        patch_grid patches = start;
+        meter.measure([&] { advance_populations(patches, factors, 3, 0); });
+    };
+}
+
+TEST_CASE("Benchmark binomial cohort draws against per-individual draws", "[.][benchmark]") {
+    for (int max_count : {6, 600}) {
+        std::mt19937 setup_gen(1);
+        const patch_grid start = make_populated_grid(300, 300, max_count, setup_gen);
+        transition_factors factors;
+        factors.update(start);
+        BENCHMARK_ADVANCED("per individual, up to " + std::to_string(max_count) + " seeds per patch")(Catch::Benchmark::Chronometer meter) {
+            patch_grid patches = start;
+            std::mt19937 gen(3);
+            meter.measure([&] { advance_populations(patches, factors, gen); });
+        };
+        BENCHMARK_ADVANCED("binomial cohorts, up to " + std::to_string(max_count) + " seeds per patch")(Catch::Benchmark::Chronometer meter) {
+            patch_grid patches = start;
+            std::mt19937 gen(3);
+            meter.measure([&] { advance_cohorts(patches, factors, gen); });
+        };
+    }
+}
+
+TEST_CASE("Benchmark population dynamics of sparse early post-fire populations", "[.][benchmark]") {
+    for (double occupied_share : {0.01, 0.1, 1.0}) {
+        std::mt19937 setup_gen(1);
+        patch_grid start = make_populated_grid(300, 300, 6, setup_gen);
+        std::uniform_real_distribution<double> rand_01(0.0, 1.0);
+        for (auto& p : start) {
+            if (rand_01(setup_gen) >= occupied_share) {
+                p.N_seeds = p.N_height_class_1 = p.N_height_class_2 = p.N_height_class_3 = p.N_height_class_4 = {0, 0};
+            }
+        }
+        start.update_occupancy();
+        transition_factors factors;
+        factors.update(start);
+        const std::string share = std::to_string(static_cast<int>(occupied_share * 100)) + " % occupied";
+        BENCHMARK_ADVANCED("all patches, " + share)(Catch::Benchmark::Chronometer meter) {
+            patch_grid patches = start;
+            std::mt19937 gen(3);
+            meter.measure([&] { original_pop_dynamics(patches, gen); });
+        };
+        BENCHMARK_ADVANCED("occupied patches, " + share)(Catch::Benchmark::Chronometer meter) {
+            patch_grid patches = start;
+            std::mt19937 gen(3);
+            meter.measure([&] { advance_populations(patches, factors, gen); });
+        };
+    }
+}
+
+// restores the counts of a grid to a saved copy of its population store, cheaper than copying the grid
+static void restore_counts(patch_grid& patches, const std::vector<int>& counts) {
+    std::copy(counts.begin(), counts.end(), patches.get_populations().counts(0, 0));
+    patches.update_occupancy();
+}
+
+static std::vector<int> saved_counts(const patch_grid& patches) {
+    const int* counts = patches.get_populations().counts(0, 0);
+    return std::vector<int>(counts, counts + N_stages * N_species * patches.size());
+}
+
+TEST_CASE("Benchmark strong scaling of the parallel population dynamics", "[.][benchmark]") {
+    for (int size : {300, 3000}) {
+        std::mt19937 setup_gen(1);
+        patch_grid patches = make_populated_grid(size, size, 6, setup_gen);
+        const std::vector<int> counts = saved_counts(patches);
+        transition_factors factors;
+        factors.update(patches);
+        thread_pool pool;
+        for (int N_threads : {1, 2, 4, 8, 16, 32, 64}) {
+            pool.resize(N_threads);
+            const std::string name = std::to_string(size) + " x " + std::to_string(size) + ", " + std::to_string(N_threads) + " threads";
+            BENCHMARK_ADVANCED("per individual, " + name)(Catch::Benchmark::Chronometer meter) {
+                restore_counts(patches, counts);
+                meter.measure([&] { advance_populations_parallel(patches, factors, 3, 0, pool); });
+            };
+            BENCHMARK_ADVANCED("binomial cohorts, " + name)(Catch::Benchmark::Chronometer meter) {
+                restore_counts(patches, counts);
+                meter.measure([&] { advance_cohorts_parallel(patches, factors, 3, 0, pool); });
+            };
+        }
+    }
+}
+
+TEST_CASE("Benchmark weak scaling of the parallel population dynamics", "[.][benchmark]") {
+    // 300 x 300 patches per thread, the time stays constant with perfect scaling
+    thread_pool pool;
+    for (int N_threads : {1, 2, 4, 8, 16, 32, 64}) {
+        std::mt19937 setup_gen(1);
+        patch_grid patches = make_populated_grid(300 * N_threads, 300, 6, setup_gen);
+        const std::vector<int> counts = saved_counts(patches);
+        transition_factors factors;
+        factors.update(patches);
+        pool.resize(N_threads);
+        BENCHMARK_ADVANCED("per individual, " + std::to_string(300 * N_threads) + " x 300, " + std::to_string(N_threads) + " threads")(Catch::Benchmark::Chronometer meter) {
+            restore_counts(patches, counts);
+            meter.measure([&] { advance_populations_parallel(patches, factors, 3, 0, pool); });
+        };
+    }
+}
+
+TEST_CASE("Benchmark transition factors of a large landscape", "[.][benchmark]") {
+    // light as with the nearest tree light model: reduced within 6 patches of the trees, full light elsewhere
+    patch_grid patches(3000, 3000);
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> rand_cor(0, 2999);
+    for (int t = 0; t < 90000; t++) {
+        const int x = rand_cor(gen);
+        const int y = rand_cor(gen);
+        for (int dx = -5; dx <= 5; dx++) {
+            for (int dy = -5; dy <= 5; dy++) {
+                if (patches.contains(x + dx, y + dy) && dx * dx + dy * dy > 0 && dx * dx + dy * dy < 36) {
+                    float& light = patches.at(x + dx, y + dy).light_availability;
+                    light = std::min(light == 0.0f ? 1.0f : light, 1 - 1 / std::sqrt(float(dx * dx + dy * dy)));
+                }
+            }
+        }
+    }
+    for (auto& p : patches) {
+        if (p.light_availability == 0.0f) {
+            p.light_availability = 1.0f;
+        }
+    }
+    transition_factors factors;
+    BENCHMARK("environment classes of 3000 x 3000 patches") {
+        factors.update(patches);
+        return factors.N_classes();
+    };
+}
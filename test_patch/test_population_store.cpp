@@ -0,0 +1,138 @@
+// test population_store.cpp and the patches viewing it
+#include "catch.hpp"
+#include "../post_fire_simulation/population_store.h"
+#include "../post_fire_simulation/patch_grid.h"
+#include <string>
+#include <vector>
+
+TEST_CASE("Test population store layout") {
+    population_store store;
+    store.reset(10);
+
+    SECTION("Test every stage and species is one contiguous array") {
+        REQUIRE(store.size() == 10);
+        for (int s = 0; s < N_stages; s++) {
+            for (int j = 0; j < N_species; j++) {
+                REQUIRE(store.counts(s, j) == store.counts(0, 0) + (s * N_species + j) * 10);
+            }
+        }
+    }
+    SECTION("Test empty patches") {
+        REQUIRE(store.is_empty(3));
+        store.counts(stage_height_class_4, 1)[3] = 1;
+        REQUIRE_FALSE(store.is_empty(3));
+        REQUIRE(store.is_empty(2));
+        REQUIRE(store.is_empty(4));
+        store.counts(stage_height_class_4, 1)[3] = -1;    // negative counts are not empty, as in patch::is_empty()
+        REQUIRE_FALSE(store.is_empty(3));
+    }
+}
+
+TEST_CASE("Test species and stage traits") {
+    static_assert(N_species == 2 && N_stages == 5, "birch and oak with seeds and 4 height classes");
+    static_assert(species_index('b') == 0 && species_index('o') == 1, "species in the order of model_species");
+    REQUIRE(species_index('x') == -1);
+    REQUIRE(std::string(model_species[species_index('o')].name) == "Oak");
+    REQUIRE(growth_of_stage<N_stages>(stage_seeds) == stage_growth::growth);
+    REQUIRE(growth_of_stage<N_stages>(stage_height_class_1) == stage_growth::germination_growth);
+    REQUIRE(growth_of_stage<N_stages>(stage_height_class_3) == stage_growth::growth);
+    REQUIRE(growth_of_stage<N_stages>(stage_height_class_4) == stage_growth::none);
+    REQUIRE(growth_of_stage<8>(stage_height_class_4) == stage_growth::growth);
+}
+
+TEST_CASE("Test population store of another configuration") {
+    basic_population_store<6, 8> store;
+    store.reset(4);
+    REQUIRE(store.counts(7, 5) == store.counts(0, 0) + (7 * 6 + 5) * 4);
+    REQUIRE(store.is_empty(2));
+    store.counts(7, 5)[2] = 1;
+    REQUIRE_FALSE(store.is_empty(2));
+    REQUIRE(store.is_empty(3));
+}
+
+TEST_CASE("Test patches of a grid view the population store") {
+    patch_grid grid(30, 20);
+    population_store& store = grid.get_populations();
+    REQUIRE(store.size() == grid.size());
+
+    SECTION("Test writes through the patch reach the store") {
+        grid.at(3, 4).update_N_seeds(5, 'b');
+        grid.at(3, 4).N_height_class_2[1] = 7;
+        REQUIRE(store.counts(stage_seeds, 0)[grid.index(3, 4)] == 5);
+        REQUIRE(store.counts(stage_height_class_2, 1)[grid.index(3, 4)] == 7);
+    }
+    SECTION("Test writes to the store are seen by the patch") {
+        store.counts(stage_height_class_3, 0)[grid.index(7, 2)] = 4;
+        REQUIRE(grid.at(7, 2).N_height_class_3[0] == 4);
+        REQUIRE(grid.at(7, 2).get_all_N_seeds_saplings() == 4);
+    }
+    SECTION("Test the patch id is derived from the coordinates") {
+        REQUIRE(grid.at(12, 5).get_patch_id() == "12_5");
+    }
+}
+
+TEST_CASE("Test copies of patches and grids own their counts") {
+    patch_grid grid(10, 10);
+    grid.at(1, 2).update_N_seeds(3, 'o');
+    grid.at(1, 2).light_availability = 0.5f;
+    grid.mark_occupied(grid.index(1, 2));
+
+    SECTION("Test a patch copy is independent of the grid") {
+        patch copy = grid.at(1, 2);
+        REQUIRE(copy.N_seeds[1] == 3);
+        REQUIRE(copy.light_availability == 0.5f);
+        REQUIRE(copy.get_patch_id() == "1_2");
+        copy.N_seeds[1] = 9;
+        REQUIRE(grid.at(1, 2).N_seeds[1] == 3);
+    }
+    SECTION("Test assigning a patch copies the counts into the grid") {
+        patch p;
+        p.N_height_class_1 = {2, 6};
+        grid.at(0, 0) = p;
+        REQUIRE(grid.get_populations().counts(stage_height_class_1, 1)[grid.index(0, 0)] == 6);
+        REQUIRE(grid.at(0, 0).x_y_cor[0] == 0);
+        p.N_height_class_1[1] = 0;
+        REQUIRE(grid.at(0, 0).N_height_class_1[1] == 6);
+    }
+    SECTION("Test a grid copy views its own store") {
+        patch_grid copy = grid;
+        REQUIRE(copy.at(1, 2).N_seeds[1] == 3);
+        REQUIRE(copy.is_occupied(copy.index(1, 2)));
+        copy.at(1, 2).N_seeds[1] = 0;
+        REQUIRE(grid.at(1, 2).N_seeds[1] == 3);
+        REQUIRE(copy.get_populations().counts(stage_seeds, 1)[copy.index(1, 2)] == 0);
+
+        patch_grid moved = std::move(copy);
+        moved.at(1, 2).N_seeds[1] = 8;
+        REQUIRE(moved.get_populations().counts(stage_seeds, 1)[moved.index(1, 2)] == 8);
+    }
+}
+
+TEST_CASE("Benchmark counting populations of a patch grid", "[.][benchmark]") {
+    patch_grid grid(300, 300);
+    for (size_t i = 0; i < grid.size(); i += 3) {
+        grid[i].N_seeds = {5, 2};
+        grid[i].N_height_class_2 = {1, 0};
+    }
+
+    BENCHMARK("through the patch views") {
+        long long total = 0;
+        for (patch& p : grid) {
+            total += p.get_all_N_seeds_saplings();
+        }
+        return total;
+    };
+    BENCHMARK("through the store arrays") {
+        const population_store& store = grid.get_populations();
+        long long total = 0;
+        for (int s = 0; s < N_stages; s++) {
+            for (int j = 0; j < N_species; j++) {
+                const int* N = store.counts(s, j);
+                for (size_t i = 0; i < store.size(); i++) {
+                    total += N[i];
+                }
+            }
+        }
+        return total;
+    };
+}
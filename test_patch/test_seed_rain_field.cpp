@@ -0,0 +1,175 @@
+// test seed_rain_field.cpp against the exact per-seed dispersal in dispersal.cpp
+#include "catch.hpp"
+#include "../post_fire_simulation/seed_rain_field.h"
+#include "../post_fire_simulation/dispersal.h"
+#include "test_trees.h"
+#include <cmath>
+#include <vector>
+#include <random>
+
+TEST_CASE("Test expected seed stencil sums to the mean seed production") {
+    // n is uniform in 0 .. max_seed_production - 1, so the expected seed production is (max - 1) / 2
+    std::vector<float> birch = seed_rain_field::expected_seed_stencil(dispersal_stencil(20, 50));
+    std::vector<float> oak = seed_rain_field::expected_seed_stencil(dispersal_stencil(40, 100));
+    double birch_total = 0, oak_total = 0;
+    for (float v : birch) birch_total += v;
+    for (float v : oak) oak_total += v;
+    REQUIRE(birch_total == Approx(24.5).epsilon(1e-4));
+    REQUIRE(oak_total == Approx(49.5).epsilon(1e-4));
+
+    SECTION("Test truncated kernels keep every seed inside the stencil") {
+        for (dispersal_kernel_type kernel : {dispersal_kernel_type::exponential, dispersal_kernel_type::student_2dt,
+                                             dispersal_kernel_type::lognormal, dispersal_kernel_type::fat_tailed}) {
+            std::vector<float> stencil = seed_rain_field::expected_seed_stencil(dispersal_stencil(20, 50, kernel));
+            double total = 0;
+            for (float v : stencil) total += v;
+            REQUIRE(stencil.size() == 81 * 81);
+            REQUIRE(total == Approx(24.5).epsilon(1e-4));
+        }
+    }
+}
+
+TEST_CASE("Test burnt trees do not contribute to the seed rain") {
+    std::vector<tree> trees = {make_tree(0, 50, 50, 'b')};
+    trees[0].set_burnt();
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+    seed_rain_field field;
+    field.build(trees, stencils, 100, 100);
+    REQUIRE(field.get_total_intensity(0) == 0);
+    REQUIRE(field.get_total_intensity(1) == 0);
+}
+
+TEST_CASE("Test cached seed rain agrees statistically with exact per-seed dispersal") {
+    const int size = 120;
+    const int N_years = 3000;
+    // one tree near the edge to include seeds lost outside the map, one in the center
+    std::vector<tree> trees = {make_tree(0, 60, 60, 'o'), make_tree(1, 5, 30, 'b')};
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+    seed_rain_field field;
+    field.build(trees, stencils, size, size);
+
+    std::mt19937 gen(7);
+    patch_grid exact(size, size);
+    patch_grid cached(size, size);
+    for (int year = 0; year < N_years; year++) {
+        disperse_seeds(trees, exact, gen);
+        field.draw_seeds(cached, gen);
+    }
+
+    SECTION("Test total seeds per species") {
+        for (int s = 0; s < 2; s++) {
+            double exact_total = 0, cached_total = 0;
+            for (const patch& p : exact) exact_total += p.N_seeds[s];
+            for (const patch& p : cached) cached_total += p.N_seeds[s];
+            double expected = field.get_total_intensity(s) * N_years;
+            // the annual total is at most uniform over 0 .. 99 seeds, sd < 30 per year
+            double tolerance = 4 * 30 * std::sqrt(N_years);
+            REQUIRE(std::abs(exact_total - expected) < tolerance);
+            REQUIRE(std::abs(cached_total - expected) < tolerance);
+        }
+    }
+    SECTION("Test seeds per patch") {
+        int N_compared = 0;
+        for (int x = 0; x < size; x++) {
+            for (int y = 0; y < size; y++) {
+                for (int s = 0; s < 2; s++) {
+                    double expected = field.get_intensity(x, y, s) * N_years;
+                    if (expected < 300) {
+                        continue;                       // only patches with enough seeds for a tight comparison
+                    }
+                    // the per-seed counts of a patch are overdispersed by the shared seed production, allow 6 Poisson sd
+                    double tolerance = 6 * std::sqrt(expected);
+                    REQUIRE(std::abs(exact.at(x, y).N_seeds[s] - expected) < tolerance);
+                    REQUIRE(std::abs(cached.at(x, y).N_seeds[s] - expected) < tolerance);
+                    N_compared++;
+                }
+            }
+        }
+        REQUIRE(N_compared > 50);
+    }
+}
+
+TEST_CASE("Test seed rain drawn from per-patch streams is reproduced from the run seed") {
+    std::vector<tree> trees = {make_tree(0, 40, 40, 'o'), make_tree(1, 20, 30, 'b')};
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+    seed_rain_field field;
+    field.build(trees, stencils, 80, 80);
+
+    patch_grid first(80, 80);
+    patch_grid second(80, 80);
+    patch_grid next_year(80, 80);
+    field.draw_seeds(first, 4, 0);
+    field.draw_seeds(second, 4, 0);
+    field.draw_seeds(next_year, 4, 1);
+    bool same_as_next_year = true;
+    for (size_t i = 0; i < first.size(); i++) {
+        REQUIRE(first[i].N_seeds == second[i].N_seeds);
+        same_as_next_year = same_as_next_year && first[i].N_seeds == next_year[i].N_seeds;
+    }
+    REQUIRE(first.N_occupied() > 0);
+    REQUIRE_FALSE(same_as_next_year);
+}
+
+TEST_CASE("Benchmark cached seed rain against exact per-seed dispersal", "[.][benchmark]") {
+    std::mt19937 gen(1);
+    std::vector<tree> trees = make_random_trees(2700, 300, 300, 0.5f, gen);
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+    patch_grid grid(300, 300);
+    seed_rain_field field;
+
+    BENCHMARK("build seed rain field") {
+        field.build(trees, stencils, 300, 300);
+    };
+    BENCHMARK("one year of exact per-seed dispersal") {
+        disperse_seeds(trees, grid, gen);
+    };
+    BENCHMARK("one year of cached seed rain") {
+        field.draw_seeds(grid, gen);
+    };
+}
+
+TEST_CASE("Test FFT convolution builds the same seed rain as stamping every tree") {
+    std::mt19937 gen(3);
+    std::vector<tree> trees = make_random_trees(300, 150, 100, 0.5f, gen);
+    trees[0].set_burnt();
+    trees.push_back(make_tree(300, 0, 0, 'o'));         // corner trees lose most seeds outside the map
+    trees.push_back(make_tree(301, 149, 99, 'b'));
+    dispersal_stencil_set stencils;
+    stencils.build(trees, dispersal_kernel_type::model, dispersal_kernel_type::fat_tailed);
+
+    seed_rain_field stamped;
+    seed_rain_field convolved;
+    stamped.build(trees, stencils, 150, 100);
+    convolved.build_by_convolution(trees, stencils, 150, 100);
+
+    for (int s = 0; s < 2; s++) {
+        REQUIRE(convolved.get_total_intensity(s) == Approx(stamped.get_total_intensity(s)).epsilon(1e-5));
+        for (int x = 0; x < 150; x++) {
+            for (int y = 0; y < 100; y++) {
+                REQUIRE(convolved.get_intensity(x, y, s) == Approx(stamped.get_intensity(x, y, s)).margin(1e-5));
+            }
+        }
+    }
+}
+
+TEST_CASE("Benchmark crossover of FFT convolution and exact per-seed dispersal", "[.][benchmark]") {
+    patch_grid grid(300, 300);
+    seed_rain_field field;
+    for (int N_trees_per_ha : {10, 100, 300, 1000, 3000}) {
+        std::mt19937 gen(1);
+        std::vector<tree> trees = make_random_trees(N_trees_per_ha * 9, 300, 300, 0.5f, gen);
+        dispersal_stencil_set stencils;
+        stencils.build(trees);
+        BENCHMARK("exact per-seed dispersal, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            disperse_seeds(trees, grid, gen);
+        };
+        BENCHMARK("FFT convolution and Poisson draws, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            field.build_by_convolution(trees, stencils, 300, 300);
+            field.draw_seeds(grid, gen);
+        };
+    }
+}
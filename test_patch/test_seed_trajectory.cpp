@@ -0,0 +1,118 @@
+// test seed_trajectory.cpp
+#include "catch.hpp"
+#include "../post_fire_simulation/dispersal_stencil.h"
+#include "../post_fire_simulation/seed_trajectory.h"
+#include "../post_fire_simulation/sim_random.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+static void fill_uniforms(seed_batch& batch, int N_seeds, splitmix64& gen) {
+    batch.resize(N_seeds);
+    for (int i = 0; i < N_seeds; i++) {
+        batch.uniforms[i] = uniform_float(gen);
+    }
+}
+
+TEST_CASE("Test seed offsets follow the direction and distance decay of the model") {
+    splitmix64 gen(1);
+    dispersal_stencil stencil(40, 100);
+    seed_batch batch;
+    int N_offsets = 0;
+    int N_equal = 0;
+    for (int N_seeds = 1; N_seeds < 100; N_seeds++) {
+        fill_uniforms(batch, N_seeds, gen);
+        stencil.generate_offsets(batch, simd_level::scalar);
+        for (int i = 0; i < N_seeds; i++) {
+            double direction = 2 * M_PI * (i + 1) / N_seeds;
+            double distance = 40 * std::pow(2.0, -3.0 * batch.uniforms[i]);
+            int offset_x = static_cast<int>(distance * std::cos(direction));
+            int offset_y = static_cast<int>(distance * std::sin(direction));
+            // the polynomials are accurate to a few float ulps, so only truncations right at a patch border may differ
+            REQUIRE(std::abs(batch.offset_x[i] - offset_x) <= 1);
+            REQUIRE(std::abs(batch.offset_y[i] - offset_y) <= 1);
+            N_equal += (batch.offset_x[i] == offset_x) + (batch.offset_y[i] == offset_y);
+            N_offsets += 2;
+        }
+    }
+    REQUIRE(N_equal > 0.999 * N_offsets);
+}
+
+TEST_CASE("Test direction tables hold the directions of every seed count") {
+    dispersal_stencil stencil(20, 50);
+    for (int N_seeds = 1; N_seeds <= 50; N_seeds++) {
+        const float* cos_directions = stencil.get_cos_directions(N_seeds);
+        const float* sin_directions = stencil.get_sin_directions(N_seeds);
+        for (int i = 1; i <= N_seeds; i++) {
+            REQUIRE(std::abs(cos_directions[i - 1] - std::cos(2 * M_PI * i / N_seeds)) < 1e-6);
+            REQUIRE(std::abs(sin_directions[i - 1] - std::sin(2 * M_PI * i / N_seeds)) < 1e-6);
+        }
+    }
+}
+
+TEST_CASE("Test vector kernels give bit-identical offsets to the scalar kernel") {
+    splitmix64 gen(2);
+    dispersal_stencil stencil(20, 200);
+    seed_batch scalar_batch;
+    seed_batch vector_batch;
+    std::vector<simd_level> levels = {simd_level::avx2, simd_level::avx512};
+    for (simd_level level : levels) {
+        if (static_cast<int>(level) > static_cast<int>(detected_simd_level())) {
+            continue;                                   // not supported by this cpu
+        }
+        for (int N_seeds = 0; N_seeds < 200; N_seeds++) {
+            fill_uniforms(scalar_batch, N_seeds, gen);
+            vector_batch.resize(N_seeds);
+            vector_batch.uniforms = scalar_batch.uniforms;
+            stencil.generate_offsets(scalar_batch, simd_level::scalar);
+            stencil.generate_offsets(vector_batch, level);
+            for (int i = 0; i < N_seeds; i++) {
+                REQUIRE(vector_batch.offset_x[i] == scalar_batch.offset_x[i]);
+                REQUIRE(vector_batch.offset_y[i] == scalar_batch.offset_y[i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Benchmark seed trajectory kernels", "[.][benchmark]") {
+    const int N_trees = 1000;
+    splitmix64 gen(3);
+    dispersal_stencil stencil(40, 100);
+    seed_batch batch;
+    fill_uniforms(batch, 100, gen);
+    std::vector<int> offsets(200);
+    std::vector<float> cos_directions(100);
+    std::vector<float> sin_directions(100);
+
+    BENCHMARK("per seed std::pow, cos and sin, 1000 oaks") {
+        for (int k = 0; k < N_trees; k++) {
+            for (int i = 1; i <= batch.N_seeds; i++) {
+                float direction = 2 * M_PI * i / batch.N_seeds;
+                float distance_decay = std::pow(2, -3 * batch.uniforms[i - 1]);
+                offsets[2 * i - 2] = static_cast<int>(40 * distance_decay * cos(direction));
+                offsets[2 * i - 1] = static_cast<int>(40 * distance_decay * sin(direction));
+            }
+        }
+        return offsets[0];
+    };
+    BENCHMARK("batch kernel, directions recomputed per tree, 1000 oaks") {
+        for (int k = 0; k < N_trees; k++) {
+            for (int i = 1; i <= batch.N_seeds; i++) {
+                direction_sincos(i, batch.N_seeds, sin_directions[i - 1], cos_directions[i - 1]);
+            }
+            generate_seed_offsets(batch, 40, cos_directions.data(), sin_directions.data(), detected_simd_level());
+        }
+        return batch.offset_x[0];
+    };
+    for (simd_level level : {simd_level::scalar, simd_level::avx2, simd_level::avx512}) {
+        if (static_cast<int>(level) > static_cast<int>(detected_simd_level())) {
+            continue;
+        }
+        BENCHMARK(std::string("batch kernel ") + simd_level_name(level) + " with direction tables, 1000 oaks") {
+            for (int k = 0; k < N_trees; k++) {
+                stencil.generate_offsets(batch, level);
+            }
+            return batch.offset_x[0];
+        };
+    }
+}
@@ -0,0 +1,54 @@
+// test the random number engines of sim_random.h
+#include "catch.hpp"
+#include "../post_fire_simulation/sim_random.h"
+#include <cmath>
+#include <set>
+#include <random>
+
+TEST_CASE("Test philox4x32 against the known answers of the reference implementation") {
+    // Random123 kat_vectors, philox4x32 with 10 rounds
+    REQUIRE(philox4x32::generate({0, 0, 0, 0}, {0, 0}) == philox4x32::block{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+    REQUIRE(philox4x32::generate({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}) ==
+            philox4x32::block{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+    REQUIRE(philox4x32::generate({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}) ==
+            philox4x32::block{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+}
+
+TEST_CASE("Test philox4x32 streams") {
+    SECTION("Test a stream is reproduced from its key") {
+        philox4x32 a(7, random_purpose::demography, 3, 12345);
+        philox4x32 b(7, random_purpose::demography, 3, 12345);
+        for (int k = 0; k < 100; k++) {
+            REQUIRE(a() == b());
+        }
+    }
+    SECTION("Test every part of the key selects another stream") {
+        std::set<std::uint32_t> first_numbers;
+        first_numbers.insert(philox4x32(7, random_purpose::demography, 3, 12345)());
+        first_numbers.insert(philox4x32(8, random_purpose::demography, 3, 12345)());
+        first_numbers.insert(philox4x32(7ULL << 32, random_purpose::demography, 3, 12345)());
+        first_numbers.insert(philox4x32(7, random_purpose::seed_rain, 3, 12345)());
+        first_numbers.insert(philox4x32(7, random_purpose::demography, 4, 12345)());
+        first_numbers.insert(philox4x32(7, random_purpose::demography, 3, 12346)());
+        REQUIRE(first_numbers.size() == 6);
+    }
+    SECTION("Test uniform floats of many short streams") {
+        // one short stream per patch is how the simulation uses them
+        std::uniform_real_distribution<float> rand_float_01(0.0f, 1.0f);
+        const int N_streams = 100000;
+        double sum = 0, sum_of_squares = 0;
+        for (int i = 0; i < N_streams; i++) {
+            philox4x32 gen(1, random_purpose::demography, 0, i);
+            for (int k = 0; k < 6; k++) {
+                float u = rand_float_01(gen);
+                REQUIRE(u >= 0.0f);
+                REQUIRE(u < 1.0f);
+                sum += u;
+                sum_of_squares += u * u;
+            }
+        }
+        const double N = 6.0 * N_streams;
+        REQUIRE(sum / N == Approx(0.5).margin(0.002));
+        REQUIRE(sum_of_squares / N - std::pow(sum / N, 2) == Approx(1.0 / 12).margin(0.001));
+    }
+}
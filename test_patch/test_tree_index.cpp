@@ -0,0 +1,144 @@
+// test tree_index.cpp queries against scanning all trees
+#include "catch.hpp"
+#include "../post_fire_simulation/tree_index.h"
+#include "../post_fire_simulation/distance_transform.h"
+#include "test_trees.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <random>
+
+static long long squared_distance(const tree& t, int x, int y) {
+    long long dx = t.x_y_cor[0] - x;
+    long long dy = t.x_y_cor[1] - y;
+    return dx * dx + dy * dy;
+}
+
+// all trees ordered by distance to (x, y), ties by position in the tree vector
+static std::vector<int> brute_force_by_distance(const std::vector<tree>& trees, int x, int y) {
+    std::vector<std::pair<long long, int>> by_distance;
+    for (size_t i = 0; i < trees.size(); i++) {
+        by_distance.emplace_back(squared_distance(trees[i], x, y), static_cast<int>(i));
+    }
+    std::sort(by_distance.begin(), by_distance.end());
+    std::vector<int> order;
+    for (auto& entry : by_distance) {
+        order.push_back(entry.second);
+    }
+    return order;
+}
+
+static std::vector<tree> make_test_trees(int N_trees, std::mt19937& gen) {
+    std::vector<tree> trees = make_random_trees(N_trees, 90, 70, 0.5f, gen);
+    trees.push_back(make_tree(N_trees, 0, 69, 'o'));            // trees on the map edges
+    trees.push_back(make_tree(N_trees + 1, 89, 0, 'b'));
+    trees.push_back(make_tree(N_trees + 2, 89, 0, 'b'));        // two trees on the same patch
+    return trees;
+}
+
+TEST_CASE("Test nearest and k nearest trees equal sorting all trees by distance") {
+    std::mt19937 gen(11);
+    for (int N_trees : {1, 5, 60, 400}) {
+        std::vector<tree> trees = make_test_trees(N_trees, gen);
+        for (int cell_size : {1, 8, 100}) {
+            tree_index index;
+            index.build(trees, 90, 70, cell_size);
+            REQUIRE(index.size() == static_cast<int>(trees.size()));
+            for (int x = 0; x < 90; x += 7) {
+                for (int y = 0; y < 70; y += 3) {
+                    std::vector<int> order = brute_force_by_distance(trees, x, y);
+                    REQUIRE(index.nearest(x, y) == order[0]);
+                    for (int k : {1, 4, 20}) {
+                        std::vector<int> expected(order.begin(), order.begin() + std::min<size_t>(k, order.size()));
+                        REQUIRE(index.k_nearest(x, y, k) == expected);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Test distance to the nearest tree of the index equals the distance transform") {
+    std::mt19937 gen(5);
+    std::vector<tree> trees = make_test_trees(120, gen);
+    tree_index index;
+    index.build(trees, 90, 70);
+    std::vector<float> distances = distance_to_nearest_tree(trees, 90, 70);
+    for (int x = 0; x < 90; x++) {
+        for (int y = 0; y < 70; y++) {
+            const tree& nearest = trees[index.nearest(x, y)];
+            REQUIRE(squared_distance(nearest, x, y) == static_cast<long long>(distances[x * 70 + y] * distances[x * 70 + y] + 0.5f));
+        }
+    }
+}
+
+TEST_CASE("Test trees within a radius equal the trees on the burnt circle") {
+    std::mt19937 gen(23);
+    std::vector<tree> trees = make_test_trees(500, gen);
+    tree_index index;
+    index.build(trees, 90, 70);
+    for (int radius : {0, 1, 10, 35, 200}) {
+        for (std::pair<int, int> center : {std::make_pair(45, 35), std::make_pair(0, 0), std::make_pair(89, 69)}) {
+            // same circle as the burnt patches of MainWindow::setup_burnt_area()
+            std::vector<int> expected;
+            for (size_t i = 0; i < trees.size(); i++) {
+                if (squared_distance(trees[i], center.first, center.second) <= radius * radius) {
+                    expected.push_back(static_cast<int>(i));
+                }
+            }
+            REQUIRE(index.within_radius(center.first, center.second, radius) == expected);
+        }
+    }
+}
+
+TEST_CASE("Test queries of an empty tree index") {
+    tree_index index;
+    index.build(std::vector<tree>{}, 10, 10);
+    REQUIRE(index.nearest(3, 3) == -1);
+    REQUIRE(index.k_nearest(3, 3, 5).empty());
+    REQUIRE(index.within_radius(3, 3, 20).empty());
+}
+
+TEST_CASE("Benchmark tree index queries against scanning all trees", "[.][benchmark]") {
+    for (int N_trees_per_ha : {10, 100, 500}) {
+        std::mt19937 gen(1);
+        std::vector<tree> trees = make_random_trees(N_trees_per_ha * 9, 300, 300, 0.5f, gen);     // 300 x 300 patches = 9 ha
+        tree_index index;
+        index.build(trees, 300, 300);
+        BENCHMARK("build, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            tree_index rebuilt;
+            rebuilt.build(trees, 300, 300);
+            return rebuilt.size();
+        };
+        BENCHMARK("burnt circle by scan, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            int N_burnt = 0;
+            for (auto& t : trees) {
+                N_burnt += squared_distance(t, 150, 150) <= 10 * 10;
+            }
+            return N_burnt;
+        };
+        BENCHMARK("burnt circle by index, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            return index.within_radius(150, 150, 10).size();
+        };
+        BENCHMARK("1000 nearest trees by scan, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            long long sum = 0;
+            for (int q = 0; q < 1000; q++) {
+                int x = (q * 37) % 300, y = (q * 91) % 300;
+                long long best = -1;
+                for (auto& t : trees) {
+                    long long d = squared_distance(t, x, y);
+                    best = best < 0 || d < best ? d : best;
+                }
+                sum += best;
+            }
+            return sum;
+        };
+        BENCHMARK("1000 nearest trees by index, " + std::to_string(N_trees_per_ha) + " trees/ha") {
+            long long sum = 0;
+            for (int q = 0; q < 1000; q++) {
+                sum += index.nearest((q * 37) % 300, (q * 91) % 300);
+            }
+            return sum;
+        };
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef TEST_TREES_H
+#define TEST_TREES_H
+
+// helpers shared by the test files to create trees the same way MainWindow::setup_trees() does
+#include "../post_fire_simulation/tree.h"
+#include <vector>
+#include <random>
+
+inline tree make_tree(int id, int x, int y, char species) {
+    tree t(id, std::vector<int>{}, species, 1, 10);
+    t.id = id;
+    t.x_y_cor = {x, y};
+    t.species = species;
+    t.update_species_params();
+    return t;
+}
+
+// randomly placed trees, the first (1 - species_ratio) share birch and the rest oak
+inline std::vector<tree> make_random_trees(int N_trees, int x_size, int y_size, float species_ratio, std::mt19937& gen) {
+    std::uniform_int_distribution<int> rand_x_cor(0, x_size - 1);
+    std::uniform_int_distribution<int> rand_y_cor(0, y_size - 1);
+    int N_birch_trees = N_trees * (1 - species_ratio);
+    std::vector<tree> trees;
+    for (int i = 0; i < N_trees; ++i) {
+        int x = rand_x_cor(gen);
+        int y = rand_y_cor(gen);
+        trees.push_back(make_tree(i, x, y, i < N_birch_trees ? 'b' : 'o'));
+    }
+    return trees;
+}
+
+#endif // TEST_TREES_H
@@ -0,0 +1,153 @@
+// test year_step.cpp against the separate dispersal, demography and counting procedures
+#include "catch.hpp"
+#include "../post_fire_simulation/year_step.h"
+#include "test_trees.h"
+#include <algorithm>
+#include <vector>
+#include <random>
+
+// patches with an environment like after MainWindow::setup_min_distance_to_tree() and a burnt strip
+static patch_grid make_environment_grid(int x_size, int y_size, std::mt19937& gen) {
+    patch_grid patches(x_size, y_size);
+    std::uniform_real_distribution<float> rand_float_01(0.0f, 1.0f);
+    for (auto& p : patches) {
+        p.light_availability = rand_float_01(gen);
+        p.water_availability = rand_float_01(gen) < 0.2f ? 0.5f : 1.0f;
+    }
+    for (int x = 0; x < x_size / 3; x++) {
+        for (int y = 0; y < y_size; y++) {
+            patches.at(x, y).set_burnt();
+        }
+    }
+    return patches;
+}
+
+static bool same_totals(const population_totals& a, const population_totals& b) {
+    for (int j = 0; j < N_species; j++) {
+        if (a.all[j] != b.all[j] || a.burnt[j] != b.burnt[j]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool same_grids(const patch_grid& a, const patch_grid& b) {
+    const int* N_a = a.get_populations().counts(0, 0);
+    const int* N_b = b.get_populations().counts(0, 0);
+    if (!std::equal(N_a, N_a + N_stages * N_species * a.size(), N_b)) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a.is_occupied(i) != b.is_occupied(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Test the fused year step equals the separate procedures") {
+    std::mt19937 gen(12);
+    const patch_grid start = make_environment_grid(90, 70, gen);
+    std::vector<tree> trees = make_random_trees(40, 90, 70, 0.5f, gen);
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+    seed_rain_field seed_rain;
+    seed_rain.build(trees, stencils, 90, 70);
+    transition_factors factors;
+    factors.update(start);
+    const std::uint64_t run_seed = 31;
+
+    for (demography_mode mode : {demography_mode::per_individual, demography_mode::binomial_cohorts}) {
+        for (int N_threads : {1, 3}) {
+            thread_pool pool(N_threads);
+            {                                       // exact per-seed dispersal
+                patch_grid separate = start;
+                patch_grid fused = start;
+                for (int year = 0; year < 4; year++) {
+                    seed_count_raster arrivals;
+                    arrivals.reset(90, 70);
+                    scatter_seeds_tiled(trees, stencils, arrivals, run_seed + year, pool);
+                    deposit_seeds(arrivals, separate);
+                    if (mode == demography_mode::binomial_cohorts) {
+                        advance_cohorts_parallel(separate, factors, run_seed, year, pool);
+                    } else {
+                        advance_populations_parallel(separate, factors, run_seed, year, pool);
+                    }
+                    const population_totals totals = advance_year_fused(fused, arrivals, factors, mode, run_seed, year, pool, 3);
+                    REQUIRE(same_grids(separate, fused));
+                    REQUIRE(same_totals(totals, count_totals(separate)));
+                }
+                REQUIRE(count_totals(fused).burnt[0][stage_seeds] > 0);
+            }
+            {                                       // seed rain
+                patch_grid separate = start;
+                patch_grid fused = start;
+                for (int year = 0; year < 4; year++) {
+                    seed_rain.draw_seeds(separate, run_seed, year);
+                    if (mode == demography_mode::binomial_cohorts) {
+                        advance_cohorts(separate, factors, run_seed, year);
+                    } else {
+                        advance_populations(separate, factors, run_seed, year);
+                    }
+                    const population_totals totals = advance_year_fused(fused, seed_rain, factors, mode, run_seed, year, pool);
+                    REQUIRE(same_grids(separate, fused));
+                    REQUIRE(same_totals(totals, count_totals(separate)));
+                }
+                REQUIRE(count_totals(fused).all[1][stage_height_class_1] > 0);
+            }
+        }
+    }
+}
+
+TEST_CASE("Test population totals count the burnt patches separately") {
+    patch_grid patches(10, 10);
+    patches.at(1, 1).N_seeds = {3, 4};
+    patches.at(1, 1).set_burnt();
+    patches.at(5, 5).N_height_class_4 = {0, 2};
+    patches.update_occupancy();
+    const population_totals totals = count_totals(patches);
+    REQUIRE(totals.all[0][stage_seeds] == 3);
+    REQUIRE(totals.all[1][stage_seeds] == 4);
+    REQUIRE(totals.burnt[1][stage_seeds] == 4);
+    REQUIRE(totals.all[1][stage_height_class_4] == 2);
+    REQUIRE(totals.burnt[1][stage_height_class_4] == 0);
+}
+
+TEST_CASE("Benchmark fused year step against separate passes", "[.][benchmark]") {
+    std::mt19937 gen(4);
+    patch_grid start = make_environment_grid(300, 300, gen);
+    std::vector<tree> trees = make_random_trees(900, 300, 300, 0.5f, gen);
+    dispersal_stencil_set stencils;
+    stencils.build(trees);
+    seed_rain_field seed_rain;
+    seed_rain.build(trees, stencils, 300, 300);
+    transition_factors factors;
+    factors.update(start);
+    thread_pool pool;
+    for (int year = 0; year < 10; year++) {         // populations of a few years after the fire
+        advance_year_fused(start, seed_rain, factors, demography_mode::binomial_cohorts, 1, year, pool);
+    }
+
+    BENCHMARK_ADVANCED("separate passes, 10 years, seed rain and binomial cohorts")(Catch::Benchmark::Chronometer meter) {
+        patch_grid patches = start;
+        meter.measure([&] {
+            long long total = 0;
+            for (int year = 10; year < 20; year++) {
+                seed_rain.draw_seeds(patches, 1, year);
+                advance_cohorts_parallel(patches, factors, 1, year, pool);
+                total += count_totals(patches).all[0][stage_seeds];
+            }
+            return total;
+        });
+    };
+    BENCHMARK_ADVANCED("fused pass, 10 years, seed rain and binomial cohorts")(Catch::Benchmark::Chronometer meter) {
+        patch_grid patches = start;
+        meter.measure([&] {
+            long long total = 0;
+            for (int year = 10; year < 20; year++) {
+                total += advance_year_fused(patches, seed_rain, factors, demography_mode::binomial_cohorts, 1, year, pool).all[0][stage_seeds];
+            }
+            return total;
+        });
+    };
+}